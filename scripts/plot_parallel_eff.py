@@ -1,6 +1,7 @@
 import pandas as pd
 import glob
 import re
+import matplotlib.pyplot as plt
 
 data = {
         'branch': [],
@@ -30,3 +31,19 @@ for f in glob.glob('*/resultsNw*_nm*_nd*.csv'):
 data = pd.DataFrame(data)
 print(data)
 
+# Theoretical bounds written by testSeapodymCohortParallelismAnalyzer -csv parallelism_bound_<label>.csv
+bounds = glob.glob('parallelism_bound*.csv')
+if len(data) > 0 or bounds:
+    for (branch, nm, nd), d in data.groupby(['branch', 'milliseconds', 'numData']):
+        d = d.sort_values('numWorkers')
+        plt.errorbar(d.numWorkers, d.parallelEff_avg, yerr=d.parallelEff_std, fmt='o-',
+                     label=f'{branch} nm={nm} nd={nd}')
+    for f in bounds:
+        b = pd.read_csv(f)
+        label = re.sub(r'^parallelism_bound_?|\.csv$', '', f) or 'bound'
+        plt.plot(b.numWorkers, b.parallelEffBound, 'k--', label=f'bound {label}')
+    plt.xlabel('Number of workers')
+    plt.ylabel('Parallel efficiency')
+    plt.ylim(0, 1.05)
+    plt.legend()
+    plt.show()
@@ -1,7 +1,41 @@
+import sys
+import glob
 import pandas as pd
 import numpy as np
 import matplotlib.pyplot as plt
 
+
+def read_comm_stats(prefix):
+    """
+    Read the per-rank CSV files written by CommStats (<prefix>_rank<N>.csv)
+    :param prefix: file name prefix given to CommStats::init
+    :returns: data frame with one row per rank, operation type and target
+    """
+    files = sorted(glob.glob(f'{prefix}_rank*.csv'))
+    if not files:
+        raise FileNotFoundError(f'no {prefix}_rank*.csv files')
+    return pd.concat([pd.read_csv(f) for f in files], ignore_index=True)
+
+
+def summarize_comm_stats(stats):
+    """
+    Sum the communication statistics per operation type over the ranks and targets
+    :param stats: data frame returned by read_comm_stats
+    :returns: data frame indexed by operation with the counts, bytes, seconds and the
+              maximum time per rank
+    """
+    summary = stats.groupby('op')[['count', 'bytes', 'seconds']].sum()
+    summary['max seconds per rank'] = stats.groupby(['op', 'rank'])['seconds'].sum().groupby('op').max()
+    summary['mean latency us'] = 1.e6 * summary['seconds'] / summary['count']
+    return summary
+
+
+# python scaling.py <prefix>: summarize the communication statistics of a run
+if len(sys.argv) > 1:
+    summary = summarize_comm_stats(read_comm_stats(sys.argv[1]))
+    print(summary.to_string())
+    sys.exit(0)
+
 # obtained on hpc3 11 Jun 2025
 results = pd.DataFrame({
     'na' : np.array([10, 20, 50, 100, 200]),
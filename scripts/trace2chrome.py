@@ -0,0 +1,82 @@
+import glob
+import json
+import struct
+
+import defopt
+
+# must match TraceEventType in src/Trace.h
+EVENT_NAMES = {
+    0: 'task recv',
+    1: 'task run',
+    2: 'task init',
+    3: 'step compute',
+    4: 'put',
+    5: 'get',
+    6: 'accumulate',
+    7: 'END_TASK send',
+    8: 'dispatch',
+    9: 'queue depth',
+}
+COUNTER_EVENTS = {9}
+
+# must match TraceEvent in src/Trace.h: tBeg, tEnd, value, type, taskId, step, peer
+EVENT_FORMAT = '<qqqiiii'
+EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+
+
+def read_trace(filename):
+    """Read a trace_rank<N>.bin file written by Trace::flush
+    :param filename: file name
+    :returns: rank, list of (thread index, event tuple)
+    """
+    events = []
+    with open(filename, 'rb') as f:
+        magic = f.read(8)
+        if magic != b'SPTRACE1':
+            raise ValueError(f'{filename} is not a trace file')
+        rank, num_threads = struct.unpack('<ii', f.read(8))
+        for _ in range(num_threads):
+            tid, _pad, num_events, num_dropped = struct.unpack('<iiqq', f.read(24))
+            if num_dropped > 0:
+                print(f'Warning: rank {rank} thread {tid} dropped {num_dropped} events')
+            for _ in range(num_events):
+                events.append((tid, struct.unpack(EVENT_FORMAT, f.read(EVENT_SIZE))))
+    return rank, events
+
+
+def main(*, rundir: str='./', prefix: str='trace', output: str='trace.json'):
+    """Convert binary timeline traces to the Chrome trace JSON format
+    (load in chrome://tracing or https://ui.perfetto.dev)
+    :param rundir: directory containing the <prefix>_rank<N>.bin files
+    :param prefix: trace file prefix
+    :param output: JSON output file
+    """
+    chrome_events = []
+    for filename in sorted(glob.glob(f'{rundir}/{prefix}_rank*.bin')):
+        rank, events = read_trace(filename)
+        chrome_events.append({'name': 'process_name', 'ph': 'M', 'pid': rank,
+                              'args': {'name': f'rank {rank}'}})
+        for tid, (t_beg, t_end, value, etype, task_id, step, peer) in events:
+            name = EVENT_NAMES.get(etype, f'event {etype}')
+            # Chrome expects microseconds
+            ev = {'name': name, 'pid': rank, 'tid': tid, 'ts': t_beg * 1.e-3}
+            if etype in COUNTER_EVENTS:
+                ev['ph'] = 'C'
+                ev['args'] = {name: value}
+            else:
+                ev['args'] = {'task': task_id, 'step': step, 'peer': peer, 'value': value}
+                if t_end > t_beg:
+                    ev['ph'] = 'X'
+                    ev['dur'] = (t_end - t_beg) * 1.e-3
+                else:
+                    ev['ph'] = 'i'
+                    ev['s'] = 't'
+            chrome_events.append(ev)
+
+    with open(output, 'w') as f:
+        json.dump({'traceEvents': chrome_events, 'displayTimeUnit': 'ms'}, f)
+    print(f'Wrote {len(chrome_events)} events to {output}')
+
+
+if __name__ == '__main__':
+    defopt.run(main)
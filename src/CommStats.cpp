@@ -0,0 +1,112 @@
+#include "CommStats.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// shared state, the mutex is only taken when a thread records its first operation
+// and when reading; the counters of each thread are guarded by their own mutex
+std::mutex statsMutex;
+std::vector<std::unique_ptr<CommStats::Counters>> statsCounters;
+std::string statsPrefix = "comm_stats";
+int statsRank = -1;
+int statsKeyval = MPI_KEYVAL_INVALID;
+
+// called by MPI_Finalize, which frees the attributes of MPI_COMM_SELF first
+int writeAtFinalize(MPI_Comm, int, void*, void*) {
+    CommStats::write();
+    return MPI_SUCCESS;
+}
+
+const char* opNames[COMM_NUM_OPS] = {
+    "put", "get", "accumulate", "lock", "flush", "unlock", "fence", "shared_alloc"
+};
+
+} // namespace
+
+void
+CommStats::init(MPI_Comm comm, const std::string& prefix) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    MPI_Comm_rank(comm, &statsRank);
+    statsPrefix = prefix;
+    if (statsKeyval == MPI_KEYVAL_INVALID) {
+        MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, writeAtFinalize, &statsKeyval, nullptr);
+        MPI_Comm_set_attr(MPI_COMM_SELF, statsKeyval, nullptr);
+    }
+}
+
+CommStats::Counters*
+CommStats::registerThread() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    statsCounters.push_back(std::make_unique<Counters>());
+    return statsCounters.back().get();
+}
+
+const char*
+CommStats::getName(CommOp op) {
+    return opNames[op];
+}
+
+CommStats::Entry
+CommStats::getTotal(CommOp op) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    Entry total;
+    for (const auto& c : statsCounters) {
+        std::lock_guard<std::mutex> threadLock(c->mutex);
+        for (const auto& ops : c->targets) {
+            const Entry& e = ops[op];
+            total.count += e.count;
+            total.bytes += e.bytes;
+            total.ns += e.ns;
+            for (int k = 0; k < NUM_BUCKETS; ++k) total.histogram[k] += e.histogram[k];
+        }
+    }
+    return total;
+}
+
+void
+CommStats::write(const std::string& prefix) {
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    if (statsRank < 0) MPI_Comm_rank(MPI_COMM_WORLD, &statsRank);
+    std::string filename = (prefix.empty() ? statsPrefix : prefix) + "_rank" + std::to_string(statsRank) + ".csv";
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Error: unable to write communication statistics " << filename << '\n';
+        return;
+    }
+
+    // merge the threads
+    std::vector<std::array<Entry, COMM_NUM_OPS> > targets;
+    for (const auto& c : statsCounters) {
+        std::lock_guard<std::mutex> threadLock(c->mutex);
+        if (c->targets.size() > targets.size()) targets.resize(c->targets.size());
+        for (std::size_t t = 0; t < c->targets.size(); ++t) {
+            for (int op = 0; op < COMM_NUM_OPS; ++op) {
+                const Entry& e = c->targets[t][op];
+                Entry& m = targets[t][op];
+                m.count += e.count;
+                m.bytes += e.bytes;
+                m.ns += e.ns;
+                for (int k = 0; k < NUM_BUCKETS; ++k) m.histogram[k] += e.histogram[k];
+            }
+        }
+    }
+
+    out << "rank,op,target,count,bytes,seconds";
+    for (int k = 0; k < NUM_BUCKETS; ++k) out << ",hist_" << k;
+    out << '\n';
+    for (int op = 0; op < COMM_NUM_OPS; ++op) {
+        for (std::size_t t = 0; t < targets.size(); ++t) {
+            const Entry& e = targets[t][op];
+            if (e.count == 0) continue;
+            out << statsRank << ',' << opNames[op] << ',' << int(t) - 1 << ',' << e.count << ','
+                << e.bytes << ',' << e.ns * 1.e-9;
+            for (int k = 0; k < NUM_BUCKETS; ++k) out << ',' << e.histogram[k];
+            out << '\n';
+        }
+    }
+}
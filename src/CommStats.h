@@ -0,0 +1,177 @@
+#include <mpi.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef SEAPODYM_COMM_STATS_H
+#define SEAPODYM_COMM_STATS_H
+
+/**
+ * @brief Types of communication operations counted by CommStats
+ */
+enum CommOp : std::int32_t {
+    COMM_PUT = 0,            // RMA put issued, bytes moved
+    COMM_GET = 1,            // RMA get issued, bytes moved
+    COMM_ACCUMULATE = 2,     // RMA accumulate issued, bytes moved
+    COMM_LOCK = 3,           // MPI_Win_lock/lock_all, the wait for the lock (and for the collector mutex)
+    COMM_FLUSH = 4,          // MPI_Win_flush, completion of the pending operations
+    COMM_UNLOCK = 5,         // MPI_Win_unlock/unlock_all, completion and release
+    COMM_FENCE = 6,          // MPI_Win_fence
+    COMM_SHARED_ALLOC = 7,   // MPI_Win_allocate_shared, bytes allocated
+    COMM_NUM_OPS = 8,
+};
+
+/**
+ * @brief Optional accounting of the RMA operations of DistDataCollector,
+ *        MultiFieldCollector, SeapodymCourier and DataProvider
+ *
+ * @details For each operation type and target rank, counts the operations, the bytes and
+ *          the time spent in the call, and keeps a histogram of the call durations in
+ *          log2 buckets: bucket k counts the calls lasting [2^k, 2^(k+1)) ns. MPI may
+ *          defer the actual lock to the first flush or to the unlock, so the lock wait
+ *          under contention shows in the COMM_FLUSH and COMM_UNLOCK times as much as in
+ *          COMM_LOCK.
+ *
+ *          Each thread updates its own counters under their own mutex, which is only
+ *          contended while getTotal or write copy them, so the cost is two clock reads and
+ *          an uncontended lock per call. getTotal and write may therefore be called while
+ *          other threads communicate. A collector put counts four calls (lock, put, flush,
+ *          unlock), which is significant next to a small intra-node put: testCommStats
+ *          prints the measured cost per counted call next to the mean duration of a put.
+ *          The counters of all the threads are written to <prefix>_rank<N>.csv by write,
+ *          or at MPI_Finalize after init; scripts/scaling.py reads these files.
+ *
+ *          Use the SEAPODYM_COMM_STATS_* macros, which expand to nothing when the code
+ *          is compiled without -DSEAPODYM_COMM_STATS, the default (enable with cmake -DCOMM_STATS=ON).
+ */
+class CommStats {
+
+    public:
+
+        // number of histogram buckets, up to 2^40 ns (~18 min)
+        static const int NUM_BUCKETS = 40;
+
+        /**
+         * Counters of one operation type and target
+         */
+        struct Entry {
+            std::uint64_t count = 0;
+            std::uint64_t bytes = 0;
+            std::int64_t ns = 0;
+            std::array<std::uint32_t, NUM_BUCKETS> histogram{};
+        };
+
+        /**
+         * Per-thread counters, indexed by target rank + 1 (0: no target) and operation
+         */
+        struct Counters {
+            std::vector<std::array<Entry, COMM_NUM_OPS> > targets;
+            // taken by the owning thread in record, by the readers in getTotal and write
+            std::mutex mutex;
+        };
+
+        /**
+         * Set the output prefix and write the counters at MPI_Finalize
+         * @param comm communicator whose rank names the file
+         * @param prefix file name prefix
+         */
+        static void init(MPI_Comm comm, const std::string& prefix = "comm_stats");
+
+        /**
+         * Get the time
+         * @return nanoseconds, monotonic
+         */
+        static std::int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+         * Count an operation in the calling thread's counters
+         * @param op operation type
+         * @param target target rank, -1 if none
+         * @param bytes number of bytes
+         * @param ns duration in nanoseconds
+         */
+        static void record(CommOp op, int target, std::uint64_t bytes, std::int64_t ns) {
+            Counters* c = threadCounters();
+            std::lock_guard<std::mutex> lock(c->mutex);
+            std::size_t index = (std::size_t) (target + 1);
+            if (index >= c->targets.size()) c->targets.resize(index + 1);
+            Entry& e = c->targets[index][op];
+            e.count++;
+            e.bytes += bytes;
+            e.ns += ns;
+            int bucket = 0;
+            for (std::uint64_t v = (std::uint64_t) (ns > 0 ? ns : 1); v > 1 && bucket < NUM_BUCKETS - 1; v >>= 1) ++bucket;
+            e.histogram[bucket]++;
+        }
+
+        /**
+         * Sum the counters of an operation type over the threads and the targets
+         * @param op operation type
+         * @return summed counters
+         */
+        static Entry getTotal(CommOp op);
+
+        /**
+         * Get the name of an operation type, as written in the CSV file
+         * @param op operation type
+         * @return name
+         */
+        static const char* getName(CommOp op);
+
+        /**
+         * Write the counters of all the threads of this rank to <prefix>_rank<N>.csv,
+         * one row per operation type and target. The operations still in progress in
+         * other threads are not counted
+         * @param prefix file name prefix, the prefix given to init if empty
+         */
+        static void write(const std::string& prefix = "");
+
+    private:
+
+        // get (or create) the calling thread's counters
+        static Counters* threadCounters() {
+            thread_local Counters* c = registerThread();
+            return c;
+        }
+
+        static Counters* registerThread();
+};
+
+/**
+ * @brief Count an operation spanning the lifetime of this object
+ */
+class CommStatsScope {
+    public:
+        CommStatsScope(CommOp op, int target = -1, std::uint64_t bytes = 0)
+            : op(op), target(target), bytes(bytes), tBeg(CommStats::now()) {}
+        ~CommStatsScope() {
+            CommStats::record(op, target, bytes, CommStats::now() - tBeg);
+        }
+    private:
+        CommOp op;
+        int target;
+        std::uint64_t bytes;
+        std::int64_t tBeg;
+};
+
+#define SEAPODYM_COMM_STATS_CAT2(a, b) a##b
+#define SEAPODYM_COMM_STATS_CAT(a, b) SEAPODYM_COMM_STATS_CAT2(a, b)
+
+#ifdef SEAPODYM_COMM_STATS
+    #define SEAPODYM_COMM_STATS_INIT(comm, prefix) CommStats::init(comm, prefix)
+    #define SEAPODYM_COMM_STATS_WRITE(prefix) CommStats::write(prefix)
+    // count an operation lasting until the end of the enclosing scope
+    #define SEAPODYM_COMM_STATS_SCOPE(...) CommStatsScope SEAPODYM_COMM_STATS_CAT(seapodymCommStatsScope, __LINE__)(__VA_ARGS__)
+#else
+    #define SEAPODYM_COMM_STATS_INIT(comm, prefix) ((void)0)
+    #define SEAPODYM_COMM_STATS_WRITE(prefix) ((void)0)
+    #define SEAPODYM_COMM_STATS_SCOPE(...) ((void)0)
+#endif
+
+#endif // SEAPODYM_COMM_STATS_H
@@ -1,4 +1,5 @@
 #include "DataProvider.h"
+#include "CommStats.h"
 
 DataProvider::DataProvider(MPI_Comm comm, 
                            const std::vector< std::pair<std::string, std::size_t> >& nameSizePairs)
@@ -29,7 +30,10 @@ DataProvider::DataProvider(MPI_Comm comm,
         MPI_Win win = MPI_WIN_NULL;
 
         // Allocate shared memory window for this array
-        MPI_Win_allocate_shared(bytes, sizeof(double), MPI_INFO_NULL, this->shmcomm_, &baseptr, &win);
+        {
+            SEAPODYM_COMM_STATS_SCOPE(COMM_SHARED_ALLOC, -1, bytes);
+            MPI_Win_allocate_shared(bytes, sizeof(double), MPI_INFO_NULL, this->shmcomm_, &baseptr, &win);
+        }
 
         // Everyone queries origin memory
         MPI_Aint size_mpi;
@@ -4,9 +4,29 @@
 #include <string>
 #include <vector>
 #include <cmath> // std::isnan()
+#include <mutex>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
-DistDataCollector::DistDataCollector(MPI_Comm comm, int numChunks, int numSize, int rootRank) {
+DistDataCollector::DistDataCollector(MPI_Comm comm, std::size_t numChunks, std::size_t numSize, int rootRank,
+                                     std::size_t maxSegmentBytes) {
+    this->init(comm, numChunks, numSize, rootRank, maxSegmentBytes, "");
+}
+
+DistDataCollector::DistDataCollector(MPI_Comm comm, std::size_t numChunks, std::size_t numSize,
+                                     const std::string& filename, int rootRank,
+                                     std::size_t maxSegmentBytes) {
+    this->init(comm, numChunks, numSize, rootRank, maxSegmentBytes, filename);
+}
+
+void
+DistDataCollector::init(MPI_Comm comm, std::size_t numChunks, std::size_t numSize, int rootRank,
+                        std::size_t maxSegmentBytes, const std::string& filename) {
     this->comm = comm;
+    this->filename = filename;
     this->rootRank = rootRank;
     int rank, nproc;
     MPI_Comm_rank(comm, &rank);
@@ -15,14 +35,56 @@ DistDataCollector::DistDataCollector(MPI_Comm comm, int numChunks, int numSize,
     this->numChunks = numChunks;
     this->numSize = numSize;
 
-    // Allocate and create the window, zero size on ranks other than rootRank
-    MPI_Aint winSize = (rank == rootRank) ? (numChunks * numSize * sizeof(double)) : 0;
-    MPI_Win_allocate(winSize, sizeof(double), MPI_INFO_NULL,
-                        comm, &this->collectedData, &this->win);
+    // a chunk is transferred in a single MPI call, whose count is an int
+    if (numSize > (std::size_t) std::numeric_limits<int>::max()) {
+        std::ostringstream msg;
+        msg << "DistDataCollector: chunk size " << numSize << " exceeds the MPI count limit";
+        throw std::runtime_error(msg.str());
+    }
+
+    // whole chunks per segment, at least one
+    std::size_t chunkBytes = std::max<std::size_t>(numSize * sizeof(double), 1);
+    this->numChunksPerSegment = std::max<std::size_t>(maxSegmentBytes / chunkBytes, 1);
+    std::size_t numSegments = std::max<std::size_t>((numChunks + this->numChunksPerSegment - 1) / this->numChunksPerSegment, 1);
+
+    // Map the backing file on rootRank. Any rank failing would leave the others
+    // blocked in the collective window creation, hence the agreement
+    int ok = 1;
+    if (!filename.empty() && rank == rootRank) {
+        ok = this->mapFile(numChunks * numSize * sizeof(double)) ? 1 : 0;
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, rootRank, comm);
+    if (!ok) {
+        std::ostringstream msg;
+        msg << "DistDataCollector: failed to map " << filename << " on rank " << rootRank;
+        throw std::runtime_error(msg.str());
+    }
+
+    // Allocate and create the windows, zero size on ranks other than rootRank
+    this->segments.resize(numSegments, nullptr);
+    this->wins.resize(numSegments, MPI_WIN_NULL);
+    for (std::size_t segment = 0; segment < numSegments; ++segment) {
+        std::size_t chunkBeg = segment * this->numChunksPerSegment;
+        std::size_t segmentChunks = std::min(this->numChunksPerSegment, numChunks - std::min(chunkBeg, numChunks));
+        std::size_t segmentSize = segmentChunks * numSize;
+        MPI_Aint winSize = (rank == rootRank) ? (MPI_Aint) (segmentSize * sizeof(double)) : 0;
+        if (filename.empty()) {
+            MPI_Win_allocate(winSize, sizeof(double), MPI_INFO_NULL,
+                                comm, &this->segments[segment], &this->wins[segment]);
+        } else {
+            // expose the mapped file, the segments are consecutive in the file
+            double* base = (rank == rootRank) ? static_cast<double*>(this->mapped) + chunkBeg * numSize : nullptr;
+            MPI_Win_create(base, winSize, sizeof(double), MPI_INFO_NULL, comm, &this->wins[segment]);
+            this->segments[segment] = base;
+        }
 
-    // Initialize the collected data with bad values
-    if (rank == rootRank) {
-        std::fill(this->collectedData, this->collectedData + (numChunks * numSize), BAD_VALUE);
+        // Initialize the collected data with bad values. A backing file is left sparse,
+        // filling it would write the whole file before any chunk arrives
+        if (rank == rootRank && filename.empty()) {
+            std::fill(this->segments[segment], this->segments[segment] + segmentSize, BAD_VALUE);
+        } else if (rank != rootRank) {
+            this->segments[segment] = nullptr;
+        }
     }
 
     // MPI_Win_allocate is collective and returns on every rank once the
@@ -36,37 +98,101 @@ DistDataCollector::DistDataCollector(MPI_Comm comm, int numChunks, int numSize,
 
 DistDataCollector::~DistDataCollector() {
     
-    if (this->win != MPI_WIN_NULL) {
-        MPI_Win_free(&this->win);
-        this->win = MPI_WIN_NULL;
-    }
+    this->free();
     // No need to free the data, MPI_Win_free will free the pointer
     //MPI_Free_mem(this->collectedData);
 }
 
+bool
+DistDataCollector::mapFile(std::size_t numBytes) {
+    int fd = open(this->filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    // the file is sparse until the pages are written
+    if (numBytes > 0 && ftruncate(fd, (off_t) numBytes) != 0) {
+        close(fd);
+        return false;
+    }
+    void* ptr = nullptr;
+    if (numBytes > 0) {
+        ptr = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    // the mapping keeps the file open
+    close(fd);
+    if (ptr == MAP_FAILED) return false;
+    this->mapped = ptr;
+    this->mappedBytes = numBytes;
+    return true;
+}
+
+void
+DistDataCollector::writeBack() {
+    if (this->mapped) msync(this->mapped, this->mappedBytes, MS_ASYNC);
+}
+
+void
+DistDataCollector::free() {
+    for (MPI_Win& w : this->wins) {
+        if (w != MPI_WIN_NULL) MPI_Win_free(&w);
+    }
+    //No need to free the data, MPI_Win_free will free the pointer
+    //MPI_Free_mem(this->collectedData);
+
+    // the file must be complete once free returns
+    if (this->mapped) {
+        msync(this->mapped, this->mappedBytes, MS_SYNC);
+        munmap(this->mapped, this->mappedBytes);
+        this->mapped = nullptr;
+        this->mappedBytes = 0;
+    }
+    std::fill(this->segments.begin(), this->segments.end(), nullptr);
+}
+
 void 
 DistDataCollector::fence() {
-    MPI_Win_fence(0, this->win);
+    SEAPODYM_COMM_STATS_SCOPE(COMM_FENCE);
+    for (MPI_Win w : this->wins) MPI_Win_fence(0, w);
 }
 
 void
-DistDataCollector::put(int chunkId, const double* data) {
+DistDataCollector::put(std::size_t chunkId, const double* data) {
 
-    // Synchronize before RMA operation. Each rank will write
-    // disjoint pieces of data, so we can use shared locks
-    MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, this->win);
+    SEAPODYM_TRACE_SCOPE(TRACE_PUT, chunkId, -1, this->rootRank, this->numSize * sizeof(double));
+
+    MPI_Aint disp;
+    MPI_Win w = this->locate(chunkId, disp);
+
+    // Synchronize before RMA operation, unless within startEpoch/endEpoch. Each rank
+    // will write disjoint pieces of data, so we can use shared locks. The wait for the
+    // other threads of the process counts as lock time
+    std::unique_lock<std::mutex> guard(this->rmaEpochMutex, std::defer_lock);
+    bool lock;
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, this->rootRank);
+        guard.lock();
+        lock = !this->inEpoch;
+        if (lock) MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, w);
+    }
 
     // Put local_data into the appropriate slice on rootRank
-    MPI_Put(data, this->numSize, MPI_DOUBLE,
-                this->rootRank, chunkId * this->numSize, this->numSize, MPI_DOUBLE, this->win);
-    MPI_Win_flush(this->rootRank, this->win);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_PUT, this->rootRank, this->numSize * sizeof(double));
+        MPI_Put(data, (int) this->numSize, MPI_DOUBLE,
+                    this->rootRank, disp, (int) this->numSize, MPI_DOUBLE, w);
+    }
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_FLUSH, this->rootRank);
+        MPI_Win_flush(this->rootRank, w);
+    }
 
     // Synchronize after RMA operations
-    MPI_Win_unlock(this->rootRank, this->win);
+    if (lock) {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, this->rootRank);
+        MPI_Win_unlock(this->rootRank, w);
+    }
 }
 
 std::vector<double>
-DistDataCollector::get(int chunkId) {
+DistDataCollector::get(std::size_t chunkId) {
 
     std::vector<double> data(this->numSize);
     this->get(chunkId, data.data());
@@ -75,33 +201,76 @@ DistDataCollector::get(int chunkId) {
 }
 
 void
-DistDataCollector::get(int chunkId, double* buffer) {
+DistDataCollector::get(std::size_t chunkId, double* buffer) {
+
+    SEAPODYM_TRACE_SCOPE(TRACE_GET, chunkId, -1, this->rootRank, this->numSize * sizeof(double));
+
+    MPI_Aint disp;
+    MPI_Win w = this->locate(chunkId, disp);
 
-    // Synchronize before RMA operation. Each rank will read
-    // disjoint pieces of data, so we can use shared locks
-    MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, this->win);
+    // Synchronize before RMA operation, unless within startEpoch/endEpoch. Each rank
+    // will read disjoint pieces of data, so we can use shared locks. The wait for the
+    // other threads of the process counts as lock time
+    std::unique_lock<std::mutex> guard(this->rmaEpochMutex, std::defer_lock);
+    bool lock;
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, this->rootRank);
+        guard.lock();
+        lock = !this->inEpoch;
+        if (lock) MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, w);
+    }
 
     // Get the appropriate slice from rootRank
-    MPI_Get(buffer, this->numSize, MPI_DOUBLE,
-                this->rootRank, chunkId * this->numSize, this->numSize, MPI_DOUBLE, this->win);
-    MPI_Win_flush(this->rootRank, this->win);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_GET, this->rootRank, this->numSize * sizeof(double));
+        MPI_Get(buffer, (int) this->numSize, MPI_DOUBLE,
+                    this->rootRank, disp, (int) this->numSize, MPI_DOUBLE, w);
+    }
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_FLUSH, this->rootRank);
+        MPI_Win_flush(this->rootRank, w);
+    }
 
     // Synchronize after RMA operations
-    MPI_Win_unlock(this->rootRank, this->win);
+    if (lock) {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, this->rootRank);
+        MPI_Win_unlock(this->rootRank, w);
+    }
 }
 
 void
-DistDataCollector::accumulate(int chunkId, const double* data) {
+DistDataCollector::accumulate(std::size_t chunkId, const double* data) {
 
-    // Shared lock: concurrent MPI_Accumulate calls with the same op (MPI_SUM)
-    // from different origins are safe under shared locks per the MPI standard.
-    MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, this->win);
+    SEAPODYM_TRACE_SCOPE(TRACE_ACCUMULATE, chunkId, -1, this->rootRank, this->numSize * sizeof(double));
 
-    MPI_Accumulate(data, this->numSize, MPI_DOUBLE,
-                   this->rootRank, chunkId * this->numSize, this->numSize, MPI_DOUBLE,
-                   MPI_SUM, this->win);
-    MPI_Win_flush(this->rootRank, this->win);
+    MPI_Aint disp;
+    MPI_Win w = this->locate(chunkId, disp);
 
-    MPI_Win_unlock(this->rootRank, this->win);
-}
+    // Shared lock, unless within startEpoch/endEpoch: concurrent MPI_Accumulate calls
+    // with the same op (MPI_SUM) from different origins are safe under shared locks per
+    // the MPI standard. The wait for the other threads of the process counts as lock time
+    std::unique_lock<std::mutex> guard(this->rmaEpochMutex, std::defer_lock);
+    bool lock;
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, this->rootRank);
+        guard.lock();
+        lock = !this->inEpoch;
+        if (lock) MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, w);
+    }
 
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_ACCUMULATE, this->rootRank, this->numSize * sizeof(double));
+        MPI_Accumulate(data, (int) this->numSize, MPI_DOUBLE,
+                       this->rootRank, disp, (int) this->numSize, MPI_DOUBLE,
+                       MPI_SUM, w);
+    }
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_FLUSH, this->rootRank);
+        MPI_Win_flush(this->rootRank, w);
+    }
+
+    if (lock) {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, this->rootRank);
+        MPI_Win_unlock(this->rootRank, w);
+    }
+}
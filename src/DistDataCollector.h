@@ -2,6 +2,10 @@
 #include <set>
 #include <vector>
 #include <limits>
+#include <string>
+#include <mutex>
+#include "Trace.h"
+#include "CommStats.h"
 
 #ifndef DIST_DATA_COLLECTOR
 #define DIST_DATA_COLLECTOR
@@ -10,6 +14,18 @@
 /**
  * @brief DistDataCollector is a class that collects data stored on multiple MPI processes
  *                          into a large array stored on a designated root rank
+ *
+ * @details Sizes and displacements are 64-bit. The array is split into several windows
+ *          (segments) of whole chunks when it would exceed maxSegmentBytes, so that the
+ *          collection may hold more than 2^31 values; chunk addressing is unchanged. Each
+ *          chunk must still hold fewer than 2^31 values, the MPI count of a put or get.
+ *
+ *          Given a file name, the collected array is a file mapped in memory on rootRank
+ *          (out-of-core mode): the kernel writes the pages back asynchronously and evicts
+ *          them under memory pressure, so the collection may exceed the RAM of rootRank.
+ *          The file is complete after free() and holds the chunks in order, as raw doubles.
+ *          The file is not initialized with BAD_VALUE, which would write it in full at
+ *          construction: the chunks not yet put read as zeros.
  */
 class DistDataCollector {
 
@@ -24,28 +40,92 @@ class DistDataCollector {
         // local size of the data
         std::size_t numSize;
 
-        // the array that collects the data of size numChunks * numSize on rootRank
-        double* collectedData;
+        // number of chunks per segment
+        std::size_t numChunksPerSegment;
 
-        // MPI window for remote memory access
-        MPI_Win win;
+        // segments of the collected array, numChunksPerSegment * numSize values each
+        // (the last may be shorter) on rootRank
+        std::vector<double*> segments;
+
+        // MPI window of each segment
+        std::vector<MPI_Win> wins;
+
+        /**
+         * Window and displacement of a chunk
+         * @param chunkId chunk Id
+         * @param disp set to the displacement of the chunk in its window
+         * @return window
+         */
+        MPI_Win inline locate(std::size_t chunkId, MPI_Aint& disp) const {
+            std::size_t segment = chunkId / this->numChunksPerSegment;
+            disp = (MPI_Aint) ((chunkId - segment * this->numChunksPerSegment) * this->numSize);
+            return this->wins[segment];
+        }
 
         // MPI rank that holds the collected data
         int rootRank;
 
+        // whether startEpoch was called, put/get/accumulate then skip the lock/unlock.
+        // Guarded by rmaEpochMutex
+        bool inEpoch = false;
+
+        // MPI does not allow two threads of a process to hold a lock on the same window
+        // and target at the same time (TaskStepThreadedWorker). Serializes the lock epochs
+        // of put, get and accumulate on the windows of this collector only, and the opening
+        // and closing of the startEpoch/endEpoch epoch with respect to these calls
+        std::mutex rmaEpochMutex;
+
+        // backing file on rootRank, empty when the array is in memory
+        std::string filename;
+
+        // memory mapping of the backing file
+        void* mapped = nullptr;
+        std::size_t mappedBytes = 0;
+
+        /**
+         * Create, size and map the backing file, on rootRank
+         * @param numBytes size of the file
+         * @return true on success
+         */
+        bool mapFile(std::size_t numBytes);
+
+        /**
+         * Create the windows, common to the constructors
+         */
+        void init(MPI_Comm comm, std::size_t numChunks, std::size_t numSize, int rootRank,
+                  std::size_t maxSegmentBytes, const std::string& filename);
+
         public:
 
         // initial values
         const double BAD_VALUE = std::numeric_limits<double>::quiet_NaN();
 
+        // default largest segment, 2^31 - 1 doubles
+        static constexpr std::size_t MAX_SEGMENT_BYTES = std::size_t(std::numeric_limits<int>::max()) * sizeof(double);
+
     /**
      * @brief Constructor
      * @param comm MPI communicator to use for communication
      * @param numChunks The number of array slices on rootRank
      * @param numSize The size of each slice
      * @param rootRank MPI rank that holds the collected data (default: 0)
+     * @param maxSegmentBytes largest window, in bytes; rounded to whole chunks, at least one
      */
-    DistDataCollector(MPI_Comm comm, int numChunks, int numSize, int rootRank = 0);
+    DistDataCollector(MPI_Comm comm, std::size_t numChunks, std::size_t numSize, int rootRank = 0,
+                      std::size_t maxSegmentBytes = MAX_SEGMENT_BYTES);
+
+    /**
+     * @brief Constructor, the collected array is backed by a file
+     * @param comm MPI communicator to use for communication
+     * @param numChunks The number of array slices on rootRank
+     * @param numSize The size of each slice
+     * @param filename file on rootRank, created or overwritten, preferably on a node-local disk
+     * @param rootRank MPI rank that holds the collected data (default: 0)
+     * @param maxSegmentBytes largest window, in bytes; rounded to whole chunks, at least one
+     */
+    DistDataCollector(MPI_Comm comm, std::size_t numChunks, std::size_t numSize,
+                      const std::string& filename, int rootRank = 0,
+                      std::size_t maxSegmentBytes = MAX_SEGMENT_BYTES);
 
     /**
      * @brief Destructor
@@ -53,10 +133,29 @@ class DistDataCollector {
     ~DistDataCollector();
 
     /**
-     * Get the MPI window
+     * Get the MPI window holding a chunk, for RMA operations issued by the caller
+     * @param chunkId Leading index in the collected array
+     * @param disp set to the displacement of the chunk in the window, in doubles
+     * @return window of the segment of the chunk
+     */
+    MPI_Win getWin(std::size_t chunkId, MPI_Aint& disp) const {
+        return this->locate(chunkId, disp);
+    }
+
+    /**
+     * Get the number of windows (segments)
+     * @return number
+     */
+    std::size_t getNumSegments() const {
+        return this->wins.size();
+    }
+
+    /**
+     * Make the local updates of the collected array visible to the remote accesses, and
+     * conversely, on rootRank within an epoch
      */
-    MPI_Win &getWin(){
-        return this->win;
+    void inline sync() {
+        for (MPI_Win w : this->wins) MPI_Win_sync(w);
     }
 
     /** 
@@ -68,33 +167,53 @@ class DistDataCollector {
 
     /**
      * @brief Start an epoch for RMA operations
+     * @note the epoch belongs to the process, not to the calling thread: until endEpoch,
+     *       put/get/accumulate skip the lock/unlock in all the threads. startEpoch and
+     *       endEpoch wait for the put/get/accumulate calls in progress in other threads
      */
     void inline startEpoch() {
         // Start a passive target shared local access epoch for all processes in the communicator
-        MPI_Win_lock_all(MPI_MODE_NOCHECK, this->win);
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, this->rootRank);
+        std::lock_guard<std::mutex> guard(this->rmaEpochMutex);
+        for (MPI_Win w : this->wins) MPI_Win_lock_all(MPI_MODE_NOCHECK, w);
+        this->inEpoch = true;
+    }
+
+    /**
+     * @brief Whether an epoch was started with startEpoch
+     * @return true until endEpoch
+     */
+    bool isInEpoch() {
+        std::lock_guard<std::mutex> guard(this->rmaEpochMutex);
+        return this->inEpoch;
     }
 
     /** 
      * @brief Ensure that the RMA operation is completed and the data are visible to the manager
      */
     void inline flush() {
-        MPI_Win_flush(this->rootRank, this->win);
+        SEAPODYM_COMM_STATS_SCOPE(COMM_FLUSH, this->rootRank);
+        for (MPI_Win w : this->wins) MPI_Win_flush(this->rootRank, w);
     }
 
     /** 
      * @brief End an epoch for RMA operations
      */
     void inline endEpoch() {
-        MPI_Win_unlock_all(this->win);
+        SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, this->rootRank);
+        std::lock_guard<std::mutex> guard(this->rmaEpochMutex);
+        for (MPI_Win w : this->wins) MPI_Win_unlock_all(w);
+        this->inEpoch = false;
     }   
 
     /**
      * @brief Put the local data into the collected array 
      * @param chunkId Leading index in the collected array
      * @param data Pointer to the local data to inject  
-     * @note this should be executed on the source process, typically by the worker
+     * @note this should be executed on the source process, typically by the worker. 
+     *       Within startEpoch/endEpoch, the data are put and flushed without locking.
      */
-    void put(int chunkId, const double* data);
+    void put(std::size_t chunkId, const double* data);
 
     /**
      * @brief Put the local data into the collected array (non-blocking)
@@ -103,8 +222,12 @@ class DistDataCollector {
      * @note this should be executed on the source process, typically by the worker
      * This is a non-blocking call which relies on startEpoch/flush/endEpoch to
      */
-    void inline putAsync(int chunkId, const double* data) {
-        MPI_Put(data, this->numSize, MPI_DOUBLE, this->rootRank, chunkId * this->numSize, this->numSize, MPI_DOUBLE, this->win);
+    void inline putAsync(std::size_t chunkId, const double* data) {
+        SEAPODYM_TRACE_SCOPE(TRACE_PUT, chunkId, -1, this->rootRank, this->numSize * sizeof(double));
+        SEAPODYM_COMM_STATS_SCOPE(COMM_PUT, this->rootRank, this->numSize * sizeof(double));
+        MPI_Aint disp;
+        MPI_Win w = this->locate(chunkId, disp);
+        MPI_Put(data, (int) this->numSize, MPI_DOUBLE, this->rootRank, disp, (int) this->numSize, MPI_DOUBLE, w);
     }
 
     /**
@@ -115,7 +238,7 @@ class DistDataCollector {
      * @param chunkId Leading index in the collected array
      * @param data    Pointer to the values to add (must have numSize elements)
      */
-    void accumulate(int chunkId, const double* data);
+    void accumulate(std::size_t chunkId, const double* data);
 
     /**
      * @brief Get a slice of the remote, collected array to the local worker
@@ -123,7 +246,7 @@ class DistDataCollector {
      * @return data array 
      * @note this should be executed on the source process, typically by the worker
      */
-    std::vector<double> get(int chunkId);
+    std::vector<double> get(std::size_t chunkId);
 
     /**
      * @brief Get a slice of the remote, collected array to the local worker
@@ -131,7 +254,7 @@ class DistDataCollector {
      * @param buffer will hold the fetched data
      * @note this should be executed on the source process, typically by the worker
      */
-    void get(int chunkId, double* buffer);
+    void get(std::size_t chunkId, double* buffer);
 
     /**
      * @brief Get a slice of the remote, collected array to the local worker (non-blocking)
@@ -140,24 +263,42 @@ class DistDataCollector {
      * @note this should be executed on the source process, typically by the worker. 
      * This is a non-blocking call which relies on startEpoch/flush/endEpoch to complete
      */
-    void inline getAsync(int chunkId, double* buffer) {
-        MPI_Get(buffer, this->numSize, MPI_DOUBLE, this->rootRank, chunkId * this->numSize, this->numSize, MPI_DOUBLE, this->win);
+    void inline getAsync(std::size_t chunkId, double* buffer) {
+        SEAPODYM_TRACE_SCOPE(TRACE_GET, chunkId, -1, this->rootRank, this->numSize * sizeof(double));
+        SEAPODYM_COMM_STATS_SCOPE(COMM_GET, this->rootRank, this->numSize * sizeof(double));
+        MPI_Aint disp;
+        MPI_Win w = this->locate(chunkId, disp);
+        MPI_Get(buffer, (int) this->numSize, MPI_DOUBLE, this->rootRank, disp, (int) this->numSize, MPI_DOUBLE, w);
     }
 
     /**
      * Get the pointer to the collected data
      * @return pointer
-     * @note this returns a null pointer on ranks other than rootRank
+     * @note this returns a null pointer on ranks other than rootRank, and when the
+     *       data span several segments (use getChunkPtr)
      */
     double* getCollectedDataPtr() {
-        return this->collectedData;
+        return (this->segments.size() == 1) ? this->segments[0] : nullptr;
+    }
+
+    /**
+     * Get the pointer to a chunk of the collected data
+     * @param chunkId chunk Id
+     * @return pointer to numSize values
+     * @note this returns a null pointer on ranks other than rootRank
+     */
+    double* getChunkPtr(std::size_t chunkId) {
+        std::size_t segment = chunkId / this->numChunksPerSegment;
+        double* base = this->segments[segment];
+        if (!base) return nullptr;
+        return base + (chunkId - segment * this->numChunksPerSegment) * this->numSize;
     }
 
     /** 
      * Get the number of chunks
      * @return number
      */
-    int getNumChunks() const {
+    std::size_t getNumChunks() const {
         return this->numChunks;
     }
 
@@ -165,21 +306,30 @@ class DistDataCollector {
      * Get the size of each chunk
      * @return number
      */
-    int getNumSize() const {
+    std::size_t getNumSize() const {
         return this->numSize;
     }
 
     /**
-     * @brief Free the MPI window and empty the collected data
+     * Get the backing file
+     * @return file name, empty if the array is in memory
      */
-    void free() { // Should this be removed and just implemented in the destructor?
-        if (this->win != MPI_WIN_NULL) {
-            MPI_Win_free(&this->win);
-        }
-        //No need to free the data, MPI_Win_free will free the pointer
-        //MPI_Free_mem(this->collectedData);
+    const std::string& getFilename() const {
+        return this->filename;
     }
 
+    /**
+     * @brief Start writing the modified pages of the backing file, on rootRank
+     * @note the call does not wait for the writes to complete
+     */
+    void writeBack();
+
+    /**
+     * @brief Free the MPI window and empty the collected data. The backing file, if
+     *        any, is written and unmapped
+     */
+    void free(); // Should this be removed and just implemented in the destructor?
+
     // Disable copy and assignment operations
     // to prevent accidental copying of the DistDataCollector instance
     // This is important because the class manages an MPI window and data pointer
@@ -0,0 +1,97 @@
+#include "MultiFieldCollector.h"
+#include "CommStats.h"
+#include <mutex>
+#include <cstring>
+
+MultiFieldCollector::MultiFieldCollector(MPI_Comm comm, std::size_t numChunks,
+                                         const std::vector<FieldSpec>& schema, int rootRank) {
+    this->comm = comm;
+    this->rootRank = rootRank;
+    this->numChunks = numChunks;
+    this->schema = schema;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    // struct-of-arrays layout, each field array starts on an 8 byte boundary
+    std::size_t total = 0;
+    for (const FieldSpec& spec : schema) {
+        int typeSize;
+        MPI_Type_size(spec.type, &typeSize);
+        this->elementBytes.push_back(typeSize);
+        this->fieldBytes.push_back(spec.length * typeSize);
+        this->offsets.push_back(total);
+        total += (numChunks * spec.length * typeSize + 7) / 8 * 8;
+    }
+
+    MPI_Aint winSize = (rank == rootRank) ? (MPI_Aint) total : 0;
+    MPI_Win_allocate(winSize, 1, MPI_INFO_NULL, comm, &this->collectedData, &this->win);
+    if (rank == rootRank) {
+        std::memset(this->collectedData, 0, total);
+    } else {
+        this->collectedData = nullptr;
+    }
+
+    // the data must be cleared before any put
+    MPI_Barrier(comm);
+}
+
+int
+MultiFieldCollector::getFieldIndex(const std::string& name) const {
+    for (std::size_t f = 0; f < this->schema.size(); ++f) {
+        if (this->schema[f].name == name) return (int) f;
+    }
+    return -1;
+}
+
+void
+MultiFieldCollector::put(std::size_t chunkId, const std::vector<const void*>& data) {
+
+    // the wait for the other threads of the process counts as lock time
+    std::unique_lock<std::mutex> guard(this->rmaEpochMutex, std::defer_lock);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, this->rootRank);
+        guard.lock();
+        MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, this->win);
+    }
+    for (std::size_t f = 0; f < this->schema.size() && f < data.size(); ++f) {
+        if (!data[f]) continue;
+        SEAPODYM_TRACE_SCOPE(TRACE_PUT, (int) chunkId, -1, this->rootRank, this->fieldBytes[f]);
+        SEAPODYM_COMM_STATS_SCOPE(COMM_PUT, this->rootRank, this->fieldBytes[f]);
+        const FieldSpec& spec = this->schema[f];
+        MPI_Put(data[f], (int) spec.length, spec.type, this->rootRank, this->getDisp(chunkId, (int) f),
+                (int) spec.length, spec.type, this->win);
+    }
+    // completes all the fields
+    SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, this->rootRank);
+    MPI_Win_unlock(this->rootRank, this->win);
+}
+
+void
+MultiFieldCollector::get(std::size_t chunkId, const std::vector<void*>& buffers) {
+    this->get(std::vector<std::size_t>{chunkId}, std::vector<std::vector<void*> >{buffers});
+}
+
+void
+MultiFieldCollector::get(const std::vector<std::size_t>& chunkIds,
+                         const std::vector<std::vector<void*> >& buffers) {
+
+    // the wait for the other threads of the process counts as lock time
+    std::unique_lock<std::mutex> guard(this->rmaEpochMutex, std::defer_lock);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, this->rootRank);
+        guard.lock();
+        MPI_Win_lock(MPI_LOCK_SHARED, this->rootRank, 0, this->win);
+    }
+    for (std::size_t c = 0; c < chunkIds.size(); ++c) {
+        for (std::size_t f = 0; f < this->schema.size() && f < buffers[c].size(); ++f) {
+            if (!buffers[c][f]) continue;
+            SEAPODYM_TRACE_SCOPE(TRACE_GET, (int) chunkIds[c], -1, this->rootRank, this->fieldBytes[f]);
+            SEAPODYM_COMM_STATS_SCOPE(COMM_GET, this->rootRank, this->fieldBytes[f]);
+            const FieldSpec& spec = this->schema[f];
+            MPI_Get(buffers[c][f], (int) spec.length, spec.type, this->rootRank,
+                    this->getDisp(chunkIds[c], (int) f), (int) spec.length, spec.type, this->win);
+        }
+    }
+    SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, this->rootRank);
+    MPI_Win_unlock(this->rootRank, this->win);
+}
@@ -0,0 +1,158 @@
+#include <mpi.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <mutex>
+#include "Trace.h"
+
+#ifndef MULTI_FIELD_COLLECTOR
+#define MULTI_FIELD_COLLECTOR
+
+/**
+ * @brief Field of a chunk: name, MPI element type and number of elements
+ */
+struct FieldSpec {
+    std::string name;
+    MPI_Datatype type;
+    std::size_t length;
+};
+
+/**
+ * @brief MultiFieldCollector collects chunks made of several named fields, e.g. the
+ *        density, the tagged densities and the catch at age of a cohort, into a single
+ *        window on a designated root rank
+ *
+ * @details The fields are stored struct-of-arrays: all the chunks of the first field,
+ *          then all the chunks of the second field, each field array aligned to 8 bytes.
+ *          A put or get moves any subset of the fields of a chunk in one lock epoch,
+ *          instead of one window and one epoch per field with a DistDataCollector each.
+ *          The fields are given in schema order; a null pointer skips a field.
+ */
+class MultiFieldCollector {
+
+    private:
+
+        // MPI communicator to use for communication
+        MPI_Comm comm;
+
+        // MPI rank that holds the collected data
+        int rootRank;
+
+        // number of chunks
+        std::size_t numChunks;
+
+        // chunk schema
+        std::vector<FieldSpec> schema;
+
+        // size in bytes of one element and of one chunk of each field
+        std::vector<std::size_t> elementBytes;
+        std::vector<std::size_t> fieldBytes;
+
+        // byte offset of the array of each field in the window
+        std::vector<std::size_t> offsets;
+
+        // the collected data on rootRank
+        char* collectedData = nullptr;
+
+        // MPI window for remote memory access, in bytes
+        MPI_Win win = MPI_WIN_NULL;
+
+        // serializes the lock epochs of the threads of this process on the window, see
+        // DistDataCollector
+        std::mutex rmaEpochMutex;
+
+        /**
+         * Byte displacement of a field of a chunk in the window
+         */
+        MPI_Aint inline getDisp(std::size_t chunkId, int field) const {
+            return (MPI_Aint) (this->offsets[field] + chunkId * this->fieldBytes[field]);
+        }
+
+    public:
+
+    /**
+     * @brief Constructor, collective
+     * @param comm MPI communicator to use for communication
+     * @param numChunks The number of chunks on rootRank
+     * @param schema fields of each chunk
+     * @param rootRank MPI rank that holds the collected data (default: 0)
+     */
+    MultiFieldCollector(MPI_Comm comm, std::size_t numChunks, const std::vector<FieldSpec>& schema,
+                        int rootRank = 0);
+
+    /**
+     * @brief Destructor
+     */
+    ~MultiFieldCollector() { this->free(); }
+
+    /**
+     * Get the index of a field in the schema
+     * @param name field name
+     * @return index, -1 if not found
+     */
+    int getFieldIndex(const std::string& name) const;
+
+    /**
+     * Get the chunk schema
+     * @return fields
+     */
+    const std::vector<FieldSpec>& getSchema() const { return this->schema; }
+
+    /**
+     * Get the number of chunks
+     * @return number
+     */
+    std::size_t getNumChunks() const { return this->numChunks; }
+
+    /**
+     * @brief Put the fields of a chunk into the collected array, in one lock epoch
+     * @param chunkId chunk index
+     * @param data one pointer per field of the schema, nullptr to skip the field
+     * @note this should be executed on the source process, typically by the worker
+     */
+    void put(std::size_t chunkId, const std::vector<const void*>& data);
+
+    /**
+     * @brief Get fields of a chunk from the collected array, in one lock epoch
+     * @param chunkId chunk index
+     * @param buffers one pointer per field of the schema, nullptr to skip the field
+     * @note this should be executed on the source process, typically by the worker
+     */
+    void get(std::size_t chunkId, const std::vector<void*>& buffers);
+
+    /**
+     * @brief Get fields of several chunks, e.g. all the dependencies of a cohort, in
+     *        one lock epoch
+     * @param chunkIds chunk indices
+     * @param buffers for each chunk, one pointer per field of the schema, nullptr to skip
+     */
+    void get(const std::vector<std::size_t>& chunkIds, const std::vector<std::vector<void*> >& buffers);
+
+    /**
+     * Get the pointer to a field of a chunk
+     * @param chunkId chunk index
+     * @param field field index
+     * @return pointer, null on ranks other than rootRank
+     */
+    template <class T>
+    T* getFieldPtr(std::size_t chunkId, int field) {
+        if (!this->collectedData) return nullptr;
+        return reinterpret_cast<T*>(this->collectedData + this->getDisp(chunkId, field));
+    }
+
+    /**
+     * @brief Free the MPI window and the collected data
+     */
+    void free() {
+        if (this->win != MPI_WIN_NULL) {
+            MPI_Win_free(&this->win);
+        }
+        // MPI_Win_free frees the data
+        this->collectedData = nullptr;
+    }
+
+    MultiFieldCollector(const MultiFieldCollector&) = delete;
+    MultiFieldCollector& operator=(const MultiFieldCollector&) = delete;
+};
+
+#endif // MULTI_FIELD_COLLECTOR
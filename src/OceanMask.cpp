@@ -0,0 +1,73 @@
+#include "OceanMask.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+OceanMask::OceanMask(const int* carte, int nbi, int nbj) {
+
+    this->nbi = nbi;
+    this->nbj = nbj;
+
+    // the runs are stored as ints, as MPI displacements
+    std::size_t numCells = this->getNumCells();
+    if (nbi < 0 || nbj < 0 || numCells > (std::size_t) std::numeric_limits<int>::max()) {
+        throw std::runtime_error("OceanMask: grid too large for int cell indices");
+    }
+    for (std::size_t k = 0; k < numCells; ++k) {
+        if (carte[k] == 0) continue;
+        // start a new run unless the previous cell is ocean
+        if (this->oceanIndices.empty() || this->oceanIndices.back() + 1 != k) {
+            this->runBegs.push_back((int) k);
+            this->runLengths.push_back(0);
+        }
+        this->oceanIndices.push_back(k);
+        this->runLengths.back()++;
+    }
+}
+
+void
+OceanMask::pack(const double* field, double* ocean) const {
+    // copy run by run, the runs are long away from the coasts
+    std::size_t n = 0;
+    for (std::size_t r = 0; r < this->runBegs.size(); ++r) {
+        const double* src = field + this->runBegs[r];
+        for (int k = 0; k < this->runLengths[r]; ++k) ocean[n++] = src[k];
+    }
+}
+
+std::vector<double>
+OceanMask::pack(const std::vector<double>& field) const {
+    std::vector<double> ocean(this->getNumOcean());
+    this->pack(field.data(), ocean.data());
+    return ocean;
+}
+
+void
+OceanMask::unpack(const double* ocean, double* field, double landValue) const {
+    std::fill(field, field + this->getNumCells(), landValue);
+    std::size_t n = 0;
+    for (std::size_t r = 0; r < this->runBegs.size(); ++r) {
+        double* dst = field + this->runBegs[r];
+        for (int k = 0; k < this->runLengths[r]; ++k) dst[k] = ocean[n++];
+    }
+}
+
+std::vector<double>
+OceanMask::unpack(const std::vector<double>& ocean, double landValue) const {
+    std::vector<double> field(this->getNumCells());
+    this->unpack(ocean.data(), field.data(), landValue);
+    return field;
+}
+
+MPI_Datatype
+OceanMask::createIndexedType() const {
+    // MPI displacements are ints
+    if (this->getNumCells() > (std::size_t) std::numeric_limits<int>::max()) {
+        throw std::runtime_error("OceanMask: grid too large for an MPI indexed datatype");
+    }
+    MPI_Datatype type;
+    MPI_Type_indexed((int) this->runBegs.size(), this->runLengths.data(), this->runBegs.data(),
+                     MPI_DOUBLE, &type);
+    MPI_Type_commit(&type);
+    return type;
+}
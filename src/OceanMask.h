@@ -0,0 +1,116 @@
+#include <mpi.h>
+#include <vector>
+#include <cstddef>
+
+#ifndef OCEAN_MASK
+#define OCEAN_MASK
+
+/**
+ * Class OceanMask
+ * @brief Index of the ocean cells of a (nbi x nbj) grid, to pack the cohort fields to
+ *        ocean-only vectors before they are transferred or stored, and unpack them back.
+ *
+ * @details The mask follows PMap::carte: a cell is land where the value is 0 and ocean
+ *          otherwise, stored row major (i * nbj + j). The index is built once. Transfers
+ *          then carry getNumOcean() values instead of nbi * nbj, e.g. a DistDataCollector
+ *          created with numSize = getNumOcean() and fed with packed data. Alternatively,
+ *          createIndexedType describes the ocean cells of a full field as an MPI datatype,
+ *          so that MPI gathers them without an explicit pack (SeapodymCourier::fetchOcean).
+ */
+class OceanMask {
+
+    private:
+
+        // grid dimensions
+        int nbi, nbj;
+
+        // flat index of each ocean cell, increasing
+        std::vector<std::size_t> oceanIndices;
+
+        // contiguous runs of ocean cells, first flat index and length
+        std::vector<int> runBegs;
+        std::vector<int> runLengths;
+
+    public:
+
+        /**
+         * Constructor
+         * @param carte land mask, nbi * nbj values in row major order, 0 on land
+         * @param nbi number of cells along the first dimension
+         * @param nbj number of cells along the second dimension
+         * @throw std::runtime_error if nbi * nbj exceeds INT_MAX
+         */
+        OceanMask(const int* carte, int nbi, int nbj);
+
+        /**
+         * Constructor
+         * @param carte land mask, nbi * nbj values in row major order, 0 on land
+         * @param nbi number of cells along the first dimension
+         * @param nbj number of cells along the second dimension
+         */
+        OceanMask(const std::vector<int>& carte, int nbi, int nbj) : OceanMask(carte.data(), nbi, nbj) {}
+
+        /**
+         * Get the number of cells of the grid
+         * @return nbi * nbj
+         */
+        std::size_t getNumCells() const { return (std::size_t) this->nbi * this->nbj; }
+
+        /**
+         * Get the number of ocean cells
+         * @return number
+         */
+        std::size_t getNumOcean() const { return this->oceanIndices.size(); }
+
+        /**
+         * Get the number of contiguous runs of ocean cells
+         * @return number
+         */
+        std::size_t getNumRuns() const { return this->runBegs.size(); }
+
+        /**
+         * Get the flat indices of the ocean cells
+         * @return indices, increasing
+         */
+        const std::vector<std::size_t>& getOceanIndices() const { return this->oceanIndices; }
+
+        /**
+         * Gather the ocean cells of a field
+         * @param field nbi * nbj values
+         * @param ocean will hold getNumOcean() values
+         */
+        void pack(const double* field, double* ocean) const;
+
+        /**
+         * Gather the ocean cells of a field
+         * @param field nbi * nbj values
+         * @return getNumOcean() values
+         */
+        std::vector<double> pack(const std::vector<double>& field) const;
+
+        /**
+         * Scatter ocean values back to a field
+         * @param ocean getNumOcean() values
+         * @param field will hold nbi * nbj values
+         * @param landValue value of the land cells
+         */
+        void unpack(const double* ocean, double* field, double landValue = 0.0) const;
+
+        /**
+         * Scatter ocean values back to a field
+         * @param ocean getNumOcean() values
+         * @param landValue value of the land cells
+         * @return nbi * nbj values
+         */
+        std::vector<double> unpack(const std::vector<double>& ocean, double landValue = 0.0) const;
+
+        /**
+         * Create the MPI datatype selecting the ocean cells of a field of doubles, one
+         * block per contiguous run
+         * @return committed datatype, to be freed with MPI_Type_free
+         */
+        MPI_Datatype createIndexedType() const;
+
+};
+
+#endif // OCEAN_MASK
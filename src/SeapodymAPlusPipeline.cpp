@@ -0,0 +1,107 @@
+#include "SeapodymAPlusPipeline.h"
+#include <algorithm>
+#include <thread>
+
+SeapodymAPlusPipeline::SeapodymAPlusPipeline(MPI_Comm comm, int numTimeSteps, int numData, int aPlusRank) :
+    inbox(comm, numTimeSteps, numData, aPlusRank),
+    outbox(comm, numTimeSteps, numData, aPlusRank) {
+
+    this->comm = comm;
+    this->aPlusRank = aPlusRank;
+    this->numTimeSteps = numTimeSteps;
+    this->numData = numData;
+    MPI_Comm_rank(comm, &this->rank);
+
+    this->numFeeders.assign(numTimeSteps, 1);
+    if (numTimeSteps > 0) this->numFeeders[0] = 0;
+
+    MPI_Aint winSize = (this->rank == aPlusRank) ? 2 * numTimeSteps * sizeof(int) : 0;
+    MPI_Win_allocate(winSize, sizeof(int), MPI_INFO_NULL, comm, &this->board, &this->win);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, this->win);
+    if (this->rank == aPlusRank) {
+        // the inbox and the outbox are read and written in local memory, synchronized
+        // with MPI_Win_sync within an epoch
+        this->inbox.startEpoch();
+        this->outbox.startEpoch();
+        std::fill(this->board, this->board + 2 * numTimeSteps, 0);
+        // the contributions are summed into the inbox, which must start from zero
+        for (int t = 0; t < numTimeSteps; ++t) {
+            double* sums = this->inbox.getChunkPtr(t);
+            std::fill(sums, sums + numData, 0.0);
+        }
+        this->inbox.sync();
+        MPI_Win_sync(this->win);
+    }
+
+    // the board and the inbox must be cleared before any contribution
+    MPI_Barrier(comm);
+}
+
+void
+SeapodymAPlusPipeline::contribute(int timeStep, const double* data) {
+    // the data must be complete at aPlusRank before the counter is incremented
+    this->inbox.accumulate(timeStep, data);
+    const int one = 1;
+    MPI_Accumulate(&one, 1, MPI_INT, this->aPlusRank, timeStep, 1, MPI_INT, MPI_SUM, this->win);
+    MPI_Win_flush(this->aPlusRank, this->win);
+}
+
+bool
+SeapodymAPlusPipeline::isPublished(int timeStep) {
+    int flag;
+    const int dummy = 0;
+    MPI_Fetch_and_op(&dummy, &flag, MPI_INT, this->aPlusRank, this->numTimeSteps + timeStep,
+                     MPI_NO_OP, this->win);
+    MPI_Win_flush(this->aPlusRank, this->win);
+    return flag != 0;
+}
+
+void
+SeapodymAPlusPipeline::getState(int timeStep, double* buffer) {
+    while (!this->isPublished(timeStep)) std::this_thread::yield();
+    this->outbox.get(timeStep, buffer);
+}
+
+void
+SeapodymAPlusPipeline::run(const std::function<void(int, std::vector<double>&, const double*)>& stepFunc) {
+
+    std::vector<double> state(this->numData, 0.0);
+    volatile int* arrived = this->board;
+
+    for (int t = 0; t < this->numTimeSteps; ++t) {
+
+        // wait for the feeders of this time step
+        while (true) {
+            MPI_Win_sync(this->win);
+            if (arrived[t] >= this->numFeeders[t]) break;
+            std::this_thread::yield();
+        }
+
+        // the counters are incremented after the contributions are complete, make the
+        // sums visible in local memory as well
+        this->inbox.sync();
+        stepFunc(t, state, this->inbox.getChunkPtr(t));
+
+        // publish the state, then the flag
+        std::copy(state.begin(), state.end(), this->outbox.getChunkPtr(t));
+        this->outbox.sync();
+        const int one = 1;
+        MPI_Accumulate(&one, 1, MPI_INT, this->aPlusRank, this->numTimeSteps + t, 1, MPI_INT,
+                       MPI_REPLACE, this->win);
+        MPI_Win_flush(this->aPlusRank, this->win);
+    }
+}
+
+void
+SeapodymAPlusPipeline::free() {
+    if (this->win != MPI_WIN_NULL) {
+        MPI_Win_unlock_all(this->win);
+        MPI_Win_free(&this->win);
+        if (this->rank == this->aPlusRank) {
+            this->inbox.endEpoch();
+            this->outbox.endEpoch();
+        }
+    }
+    this->inbox.free();
+    this->outbox.free();
+}
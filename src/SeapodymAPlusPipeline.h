@@ -0,0 +1,134 @@
+#include <mpi.h>
+#include <vector>
+#include <functional>
+#include "DistDataCollector.h"
+
+#ifndef SEAPODYM_APLUS_PIPELINE
+#define SEAPODYM_APLUS_PIPELINE
+
+/**
+ * Class SeapodymAPlusPipeline
+ * @brief Owns the state of the A+ (plus group) cohort and advances it on a reserved rank, or
+ *        on a dedicated thread of any rank, as soon as the contributions of its feeders arrive.
+ *
+ * @details The A+ chain is serial: A+ at time t needs A+ at time t - 1 and the cohort leaving
+ *          the last age class at time t - 1, i.e. cohort t - 1 at step numAgeGroups - 1. Rather
+ *          than scheduling the A+ steps as tasks (SeapodymCohortDependencyAnalyzer with
+ *          aPlusCohort = true), the feeders call contribute(), which adds their data into the
+ *          inbox slot of time t with MPI_Accumulate and then increments the arrival counter of
+ *          that slot. The owner of the A+ state runs run(), which waits for the contributions
+ *          of each time step in turn, applies the A+ step function and publishes the state.
+ *          A new cohort born at time t reads A+ at time t - 1 with getState, which waits
+ *          until that step is published.
+ *
+ *          The arrival counters and the published flags live in an int window on aPlusRank
+ *          that stays in a passive target epoch (MPI_Win_lock_all) for the pipeline lifetime.
+ *          run() on aPlusRank polls them in local memory after MPI_Win_sync, and syncs the
+ *          inbox (also kept in an epoch on aPlusRank) before reading the sums.
+ *
+ *          With the cohort Ids of SeapodymCohortDependencyAnalyzer, cohort c reaches the last
+ *          age class at time c and feeds A+ at time c + 1, so the default ascending task Id
+ *          order of TaskStepManager already dispatches the feeders by the time they feed A+.
+ *
+ * @see testSeapodymAPlusPipeline.cxx
+ */
+class SeapodymAPlusPipeline {
+
+    private:
+
+        // communicator
+        MPI_Comm comm;
+
+        // rank owning the A+ state
+        int aPlusRank;
+
+        // local rank
+        int rank;
+
+        // number of time steps
+        int numTimeSteps;
+
+        // number of values of the A+ state
+        int numData;
+
+        // time step -> number of contributions expected
+        std::vector<int> numFeeders;
+
+        // sums of the contributions of each time step
+        DistDataCollector inbox;
+
+        // A+ state after each time step
+        DistDataCollector outbox;
+
+        // numTimeSteps arrival counters followed by numTimeSteps published flags, on aPlusRank
+        int* board;
+
+        // board window
+        MPI_Win win;
+
+    public:
+
+        /**
+         * Constructor, collective
+         * @param comm MPI communicator
+         * @param numTimeSteps number of time steps
+         * @param numData number of values of the A+ state
+         * @param aPlusRank rank owning the A+ state
+         */
+        SeapodymAPlusPipeline(MPI_Comm comm, int numTimeSteps, int numData, int aPlusRank = 0);
+
+        /**
+         * Destructor
+         */
+        ~SeapodymAPlusPipeline() { this->free(); }
+
+        SeapodymAPlusPipeline(const SeapodymAPlusPipeline&) = delete;
+        SeapodymAPlusPipeline& operator=(const SeapodymAPlusPipeline&) = delete;
+
+        /**
+         * Set the number of contributions expected at a time step, by default one at each
+         * time step t >= 1 (cohort t - 1) and none at t = 0. Call on aPlusRank before run
+         * @param timeStep time step
+         * @param numContributions number of contribute calls for this time step
+         */
+        void setNumFeeders(int timeStep, int numContributions) {
+            this->numFeeders.at(timeStep) = numContributions;
+        }
+
+        /**
+         * Add the contribution of a feeder cohort, on any rank
+         * @param timeStep time step of the A+ step receiving the contribution
+         * @param data numData values
+         */
+        void contribute(int timeStep, const double* data);
+
+        /**
+         * Get the A+ state at the end of a time step, waits until the step is done
+         * @param timeStep time step
+         * @param buffer numData values
+         */
+        void getState(int timeStep, double* buffer);
+
+        /**
+         * Check whether the A+ state of a time step is published, without waiting
+         * @param timeStep time step
+         * @return true if getState would not wait
+         */
+        bool isPublished(int timeStep);
+
+        /**
+         * Advance the A+ state through all the time steps, on aPlusRank (possibly on a thread,
+         * which requires MPI_THREAD_MULTIPLE)
+         * @param stepFunc A+ step, takes the time step, the state (numData values, zero
+         *                 initially) to update and the sum of the contributions of the time step
+         */
+        void run(const std::function<void(int, std::vector<double>&, const double*)>& stepFunc);
+
+        /**
+         * Free the windows, call before MPI_Finalize
+         */
+        void free();
+
+};
+
+#endif // SEAPODYM_APLUS_PIPELINE
@@ -118,6 +118,22 @@ SeapodymCohortDependencyAnalyzer::getDependencyMap() const {
     return this->dependencyMap;
 }
 
+std::map<int, std::array<int, 2>>
+SeapodymCohortDependencyAnalyzer::getTimeRangeMap() const {
+    std::map<int, std::array<int, 2>> res;
+    int firstAPlusId = this->getFirstAPlusCohortId();
+    for (const auto& [id, beg] : this->stepBegMap) {
+        if (id >= firstAPlusId) {
+            int t = id - firstAPlusId;
+            res[id] = {t, t + 1};
+        } else {
+            int offset = id - this->numAgeGroups + 1;
+            res[id] = {offset + beg, offset + this->stepEndMap.at(id)};
+        }
+    }
+    return res;
+}
+
 int
 SeapodymCohortDependencyAnalyzer::getFirstAPlusCohortId() const {
     return this->numAgeGroups + this->numTimeSteps - 1;
@@ -125,6 +125,16 @@ public:
      */
     std::map<int, std::set<std::array<int, 2>>>  getDependencyMap() const;
 
+    /**
+     * Get the range of global time indices spanned by each cohort, i.e. the forcing
+     * time slabs a cohort needs. Normal cohort i is at time i + j - numAgeGroups + 1
+     * at step j; A+ cohort f+t is at time t.
+     *
+     * In the above example: 0->[0,1), 1->[0,2), 2->[0,3), 3->[1,4), 4->[2,5), 5->[3,5), 6->[4,5).
+     * @return Id: {first time index, last time index + 1} map
+     */
+    std::map<int, std::array<int, 2>> getTimeRangeMap() const;
+
     /**
      * Get the Id of the first A+ cohort, i.e. the threshold above which
      * (and including) cohort Ids represent A+ cohorts.
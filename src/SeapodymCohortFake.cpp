@@ -38,8 +38,7 @@ void SeapodymCohortFake::setStateFromArray(const std::vector<double>& array) {
 
 std::vector<double>
 SeapodymCohortFake::getArrayFromState() const {
-  // TO IMPLEMENT
-  return std::vector<double>();
+  return this->data;
 }
 
 void 
@@ -0,0 +1,134 @@
+#include "SeapodymCohortParallelismAnalyzer.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <queue>
+
+SeapodymCohortParallelismAnalyzer::SeapodymCohortParallelismAnalyzer(
+    const std::map<int, int>& stepBegMap,
+    const std::map<int, int>& stepEndMap,
+    const std::map<int, std::set<std::array<int, 2>>>& dependencyMap) {
+    this->analyze(stepBegMap, stepEndMap, dependencyMap);
+}
+
+SeapodymCohortParallelismAnalyzer::SeapodymCohortParallelismAnalyzer(
+    const SeapodymCohortDependencyAnalyzer& depAnalyzer) {
+    this->analyze(depAnalyzer.getStepBegMap(), depAnalyzer.getStepEndMap(),
+                  depAnalyzer.getDependencyMap());
+}
+
+void
+SeapodymCohortParallelismAnalyzer::analyze(
+    const std::map<int, int>& stepBegMap,
+    const std::map<int, int>& stepEndMap,
+    const std::map<int, std::set<std::array<int, 2>>>& dependencyMap) {
+
+    // Task Ids are not necessarily in topological order (e.g. normal cohorts depend
+    // on A+ cohorts with larger Ids) so visit the tasks in Kahn's order
+    std::map<int, int> inDegree;
+    std::map<int, std::vector<int>> dependents;
+    for (const auto& [task_id, beg] : stepBegMap) {
+        std::set<int> otherTaskIds;
+        for (const auto& [task_id2, step] : dependencyMap.at(task_id)) {
+            otherTaskIds.insert(task_id2);
+        }
+        inDegree[task_id] = otherTaskIds.size();
+        for (int task_id2 : otherTaskIds) {
+            dependents[task_id2].push_back(task_id);
+        }
+    }
+
+    std::queue<int> ready;
+    for (const auto& [task_id, n] : inDegree) {
+        if (n == 0) ready.push(task_id);
+    }
+
+    // time at which the task starts executing its first step
+    std::map<int, int> startTime;
+    this->totalWork = 0;
+    this->criticalPathLength = 0;
+    std::size_t numVisited = 0;
+
+    while (!ready.empty()) {
+
+        int task_id = ready.front();
+        ready.pop();
+        ++numVisited;
+
+        // a task starts once the last of its dependencies has finished. Step
+        // s of task i finishes at startTime[i] + s - stepBeg + 1
+        int start = 0;
+        for (const auto& [task_id2, step] : dependencyMap.at(task_id)) {
+            int finish = startTime.at(task_id2) + step - stepBegMap.at(task_id2) + 1;
+            start = std::max(start, finish);
+        }
+        startTime[task_id] = start;
+
+        int numSteps = stepEndMap.at(task_id) - stepBegMap.at(task_id);
+        this->totalWork += numSteps;
+        this->criticalPathLength = std::max(this->criticalPathLength, start + numSteps);
+
+        if (this->profile.size() < std::size_t(start + numSteps)) {
+            this->profile.resize(start + numSteps, 0);
+        }
+        for (int t = start; t < start + numSteps; ++t) {
+            this->profile[t]++;
+        }
+
+        for (int other : dependents[task_id]) {
+            if (--inDegree[other] == 0) ready.push(other);
+        }
+    }
+
+    if (numVisited != stepBegMap.size()) {
+        std::cerr << "Warning: the dependency graph has a cycle, "
+                  << stepBegMap.size() - numVisited << " tasks can never run\n";
+    }
+}
+
+double
+SeapodymCohortParallelismAnalyzer::getAverageParallelism() const {
+    if (this->criticalPathLength == 0) return 0.0;
+    return double(this->totalWork) / double(this->criticalPathLength);
+}
+
+int
+SeapodymCohortParallelismAnalyzer::getPeakParallelism() const {
+    if (this->profile.empty()) return 0;
+    return *std::max_element(this->profile.begin(), this->profile.end());
+}
+
+double
+SeapodymCohortParallelismAnalyzer::getSpeedupBound(int numWorkers) const {
+    if (numWorkers <= 0 || this->totalWork == 0) return 0.0;
+    // cannot do better than the critical path or than keeping all workers busy
+    int minTime = std::max((this->totalWork + numWorkers - 1) / numWorkers, this->criticalPathLength);
+    return double(this->totalWork) / double(minTime);
+}
+
+void
+SeapodymCohortParallelismAnalyzer::writeSpeedupCsv(const std::string& filename, int maxNumWorkers) const {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Error: unable to write file " << filename << '\n';
+        return;
+    }
+    out << "numWorkers,speedupBound,parallelEffBound\n";
+    for (int nw = 1; nw <= maxNumWorkers; ++nw) {
+        double speedup = this->getSpeedupBound(nw);
+        out << nw << ',' << speedup << ',' << speedup / double(nw) << '\n';
+    }
+}
+
+void
+SeapodymCohortParallelismAnalyzer::writeProfileCsv(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Error: unable to write file " << filename << '\n';
+        return;
+    }
+    out << "time,parallelism\n";
+    for (std::size_t t = 0; t < this->profile.size(); ++t) {
+        out << t << ',' << this->profile[t] << '\n';
+    }
+}
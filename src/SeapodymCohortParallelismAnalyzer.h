@@ -0,0 +1,114 @@
+#include <map>
+#include <set>
+#include <array>
+#include <vector>
+#include <string>
+#include "SeapodymCohortDependencyAnalyzer.h"
+
+#ifndef SEAPODYM_COHORT_PARALLELISM_ANALYZER
+#define SEAPODYM_COHORT_PARALLELISM_ANALYZER
+
+/**
+ * @brief Compute the parallelism profile and critical path of a (task, step) dependency graph
+ *
+ * @details Every (task, step) pair is a node of unit cost. Steps of the same task are executed
+ *          in sequence and a task can only start once all its (task, step) dependencies have
+ *          completed, which is the execution model of TaskStepManager. With an unlimited number
+ *          of workers each node finishes at the earliest possible time (ASAP schedule), which
+ *          gives the critical path length and the number of steps that can run concurrently
+ *          at any given time. For instance, the example in SeapodymCohortDependencyAnalyzer
+ *          (numAgeGroups=3, numTimeSteps=5, no A+) has 15 steps and a critical path of 5 steps.
+ *
+ *          The speedup with p workers is bounded by W/max(ceil(W/p), C), where W is the total
+ *          work and C the critical path length. Use this to find the number of workers beyond
+ *          which adding more does not help.
+ */
+class SeapodymCohortParallelismAnalyzer {
+
+private:
+
+    // total number of steps
+    int totalWork;
+
+    // length of the longest chain of steps
+    int criticalPathLength;
+
+    // number of steps that can run concurrently at time 0, 1, ... criticalPathLength - 1
+    std::vector<int> profile;
+
+    // compute the ASAP schedule
+    void analyze(const std::map<int, int>& stepBegMap,
+                 const std::map<int, int>& stepEndMap,
+                 const std::map<int, std::set<std::array<int, 2>>>& dependencyMap);
+
+public:
+
+    /**
+     * Constructor
+     * @param stepBegMap task Id to first step map
+     * @param stepEndMap task Id to last step + 1 map
+     * @param dependencyMap task Id to {(task Id, step), ...} map
+     */
+    SeapodymCohortParallelismAnalyzer(const std::map<int, int>& stepBegMap,
+                                      const std::map<int, int>& stepEndMap,
+                                      const std::map<int, std::set<std::array<int, 2>>>& dependencyMap);
+
+    /**
+     * Constructor
+     * @param depAnalyzer cohort dependency analyzer
+     */
+    SeapodymCohortParallelismAnalyzer(const SeapodymCohortDependencyAnalyzer& depAnalyzer);
+
+    /**
+     * Get the total number of steps (same as SeapodymCohortDependencyAnalyzer::getNumberOfCohortSteps)
+     * @return number
+     */
+    int getTotalWork() const { return this->totalWork; }
+
+    /**
+     * Get the critical path length in steps
+     * @return number
+     */
+    int getCriticalPathLength() const { return this->criticalPathLength; }
+
+    /**
+     * Get the number of steps that can execute concurrently at each time, assuming unlimited workers
+     * @return array of size getCriticalPathLength()
+     */
+    const std::vector<int>& getParallelismProfile() const { return this->profile; }
+
+    /**
+     * Get the average available parallelism (total work / critical path length)
+     * @return number
+     */
+    double getAverageParallelism() const;
+
+    /**
+     * Get the peak available parallelism
+     * @return number
+     */
+    int getPeakParallelism() const;
+
+    /**
+     * Get the upper bound of the speedup
+     * @param numWorkers number of workers
+     * @return speedup
+     */
+    double getSpeedupBound(int numWorkers) const;
+
+    /**
+     * Write the speedup and parallel efficiency bounds for 1...maxNumWorkers workers in CSV format
+     * @param filename output file name
+     * @param maxNumWorkers largest number of workers
+     */
+    void writeSpeedupCsv(const std::string& filename, int maxNumWorkers) const;
+
+    /**
+     * Write the parallelism profile in CSV format
+     * @param filename output file name
+     */
+    void writeProfileCsv(const std::string& filename) const;
+
+};
+
+#endif // SEAPODYM_COHORT_PARALLELISM_ANALYZER
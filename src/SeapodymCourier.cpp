@@ -1,5 +1,6 @@
 
 #include "SeapodymCourier.h"
+#include "CommStats.h"
 #include <sstream>
 #include <string>
 #include <vector>
@@ -47,17 +48,66 @@ SeapodymCourier::fetch(int source_rank) {
 
     std::vector<double> res(this->data_size);
 
+    // with an ocean mask, only the ocean cells are transferred, the land cells stay zero
+    MPI_Datatype type = this->oceanMask ? this->oceanType : MPI_DOUBLE;
+    int count = this->oceanMask ? 1 : this->data_size;
+    std::size_t bytes = (this->oceanMask ? this->oceanMask->getNumOcean() : (std::size_t) this->data_size) * sizeof(double);
+
     // Ensure the window is ready for access
     // MPI_LOCK_SHARED allows multiple processes to read from the window simultaneously
     // This is useful when multiple processes need to fetch data from the same source
     // Note: MPI_LOCK_SHARED is used here to allow concurrent reads, but it can be replaced with MPI_LOCK_EXCLUSIVE if exclusive access is needed
-    MPI_Win_lock(MPI_LOCK_SHARED, source_rank, MPI_MODE_NOCHECK, this->win);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, source_rank);
+        MPI_Win_lock(MPI_LOCK_SHARED, source_rank, MPI_MODE_NOCHECK, this->win);
+    }
     
     // Fetch the data from the remote process
-    MPI_Get(res.data(), this->data_size, MPI_DOUBLE, source_rank, 0, this->data_size, MPI_DOUBLE, this->win);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_GET, source_rank, bytes);
+        MPI_Get(res.data(), count, type, source_rank, 0, count, type, this->win);
+    }
     
     // Complete the access to the window
-    MPI_Win_unlock(source_rank, this->win);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, source_rank);
+        MPI_Win_unlock(source_rank, this->win);
+    }
+
+    return res;
+}
+
+void
+SeapodymCourier::setOceanMask(const OceanMask* mask) {
+    if (this->oceanType != MPI_DATATYPE_NULL) {
+        MPI_Type_free(&this->oceanType);
+    }
+    this->oceanMask = mask;
+    this->oceanType = mask->createIndexedType();
+}
+
+std::vector<double>
+SeapodymCourier::fetchOcean(int source_rank) {
+
+    if (this->local_rank == source_rank) {
+        return this->oceanMask->pack(std::vector<double>(this->data, this->data + this->data_size));
+    }
+
+    // contiguous on the origin, the ocean runs on the target
+    int numOcean = (int) this->oceanMask->getNumOcean();
+    std::vector<double> res(numOcean);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_LOCK, source_rank);
+        MPI_Win_lock(MPI_LOCK_SHARED, source_rank, MPI_MODE_NOCHECK, this->win);
+    }
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_GET, source_rank, numOcean * sizeof(double));
+        MPI_Get(res.data(), numOcean, MPI_DOUBLE, source_rank, 0, 1, this->oceanType, this->win);
+    }
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_UNLOCK, source_rank);
+        MPI_Win_unlock(source_rank, this->win);
+    }
 
     return res;
 }
@@ -68,18 +118,32 @@ SeapodymCourier::accumulate(int targetWorker) {
     // Need to reset the buffer to zero, otherwise it will add to the exisiting values
     std::fill(this->dataRecv.begin(), this->dataRecv.end(), 0.0);
 
+    // with an ocean mask, only the ocean cells are summed, the land cells stay zero
+    MPI_Datatype type = this->oceanMask ? this->oceanType : MPI_DOUBLE;
+    int count = this->oceanMask ? 1 : this->data_size;
+    std::size_t bytes = (this->oceanMask ? this->oceanMask->getNumOcean() : (std::size_t) this->data_size) * sizeof(double);
+
     // Ensure the window is ready for access
     // Possible values are MPI_MODE_NOCHECK, MPI_MODE_NOSTORE, MPI_MODE_NOPUT, MPI_MODE_NOSUCCEED
     // MPI_MODE_NOPRECEDE:  No RMA calls before this point can access the window
-    MPI_Win_fence(MPI_MODE_NOPRECEDE, this->winRecv);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_FENCE);
+        MPI_Win_fence(MPI_MODE_NOPRECEDE, this->winRecv);
+    }
     //MPI_Win_fence(0, this->winRecv);
 
     // The result of the reduction operation will be in this->dataRecv
-    MPI_Accumulate(this->data, this->data_size, MPI_DOUBLE, targetWorker, 0, 
-        this->data_size, MPI_DOUBLE, MPI_SUM, this->winRecv);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_ACCUMULATE, targetWorker, bytes);
+        MPI_Accumulate(this->data, count, type, targetWorker, 0,
+            count, type, MPI_SUM, this->winRecv);
+    }
 
     // Complete the access to the window, no RMA calls after this point
-    MPI_Win_fence(MPI_MODE_NOSUCCEED, this->winRecv);
+    {
+        SEAPODYM_COMM_STATS_SCOPE(COMM_FENCE);
+        MPI_Win_fence(MPI_MODE_NOSUCCEED, this->winRecv);
+    }
     //MPI_Win_fence(0, this->winRecv);
 
     return this->dataRecv;
@@ -1,6 +1,7 @@
 #include <mpi.h>
 #include <set>
 #include <vector>
+#include "OceanMask.h"
 #ifndef SEAPODYM_COURIER
 #define SEAPODYM_COURIER
 
@@ -35,6 +36,10 @@ class SeapodymCourier {
 
         // Local MPI rank
         int local_rank;
+
+        // ocean cells of the exposed data, not owned, and their MPI datatype
+        const OceanMask* oceanMask = nullptr;
+        MPI_Datatype oceanType = MPI_DATATYPE_NULL;
     public:
 
     /**
@@ -64,14 +69,32 @@ class SeapodymCourier {
     /**
      * @brief Fetch data from a remote process and store it in the local data array
      * @param source_worker Rank of the target process from which to fetch data
-     * @return data
+     * @return data, with an ocean mask (setOceanMask) only the ocean cells are
+     *         transferred and the land cells are zero
      */
     std::vector<double> fetch(int source_worker);
 
+    /**
+     * @brief Set the ocean cells of the exposed data. fetch and accumulate then only
+     *        transfer the ocean cells, fetchOcean returns them packed
+     * @param mask ocean mask of data_size cells, must outlive this instance
+     */
+    void setOceanMask(const OceanMask* mask);
+
+    /**
+     * @brief Fetch the ocean cells of the data of a remote process, the land cells are
+     *        not transferred
+     * @param source_worker Rank of the target process from which to fetch data
+     * @return packed data, mask->getNumOcean() values
+     * @note requires setOceanMask
+     */
+    std::vector<double> fetchOcean(int source_worker);
+
     /**
      * @brief Accumulate the data from all workers
      * @param targetWorker Rank of the target process to which to accumulate data
-     * @return A vector containing the accumulated data from all workers
+     * @return A vector containing the accumulated data from all workers, with an ocean
+     *         mask (setOceanMask) only the ocean cells are summed and the land cells are zero
      */
     std::vector<double> accumulate(int targetWorker); 
 
@@ -85,6 +108,10 @@ class SeapodymCourier {
 	if (this->winRecv != MPI_WIN_NULL) {
             MPI_Win_free(&this->winRecv);
 	}
+        if (this->oceanType != MPI_DATATYPE_NULL) {
+            MPI_Type_free(&this->oceanType);
+        }
+        this->oceanMask = nullptr;
         this->data = nullptr;
         this->data_size = 0;
 	this->dataRecv.clear();
@@ -0,0 +1,243 @@
+#include "SeapodymOutputSink.h"
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <stdexcept>
+
+SeapodymOutputSink::SeapodymOutputSink(DistDataCollector& collector,
+                                       std::function<std::size_t(int, int)> chunkFunc,
+                                       int numAgeGroups, int numTimeSteps, int nbi, int nbj) :
+    collector(collector) {
+
+    this->chunkFunc = chunkFunc;
+    this->numAgeGroups = numAgeGroups;
+    this->numTimeSteps = numTimeSteps;
+    this->nbi = nbi;
+    this->nbj = nbj;
+    this->numCompleted.assign(numTimeSteps, 0);
+
+    // cell indices and no land by default
+    this->lon.resize(nbi);
+    this->lat.resize(nbj);
+    for (int i = 0; i < nbi; ++i) this->lon[i] = float(i);
+    for (int j = 0; j < nbj; ++j) this->lat[j] = float(j);
+    this->mask.assign((std::size_t) nbi * nbj, 1);
+}
+
+void
+SeapodymOutputSink::addVariable(const std::string& name, int ageBeg, int ageEnd, const std::string& filename) {
+    this->variables.emplace_back();
+    Variable& var = this->variables.back();
+    var.name = name;
+    var.ageBeg = ageBeg;
+    var.ageEnd = ageEnd;
+    var.file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!var.file) throw std::runtime_error("SeapodymOutputSink: cannot open " + filename);
+    var.minVal = std::numeric_limits<float>::max();
+    var.maxVal = std::numeric_limits<float>::lowest();
+}
+
+void
+SeapodymOutputSink::setGrid(const std::vector<double>& lon, const std::vector<double>& lat,
+                            const std::vector<int>& mask) {
+    this->lon.assign(lon.begin(), lon.end());
+    this->lat.assign(lat.begin(), lat.end());
+    this->mask = mask;
+}
+
+void
+SeapodymOutputSink::setNumSlots(int numSlots) {
+    // a cohort writes up to numAgeGroups consecutive time steps, which must all have a slot
+    if (numSlots < 0 || (numSlots > 0 && numSlots < this->numAgeGroups)) {
+        throw std::invalid_argument("SeapodymOutputSink: the number of slots must be 0 or at least the number of age groups");
+    }
+    this->numSlots = numSlots;
+}
+
+bool
+SeapodymOutputSink::canDispatch(int taskId) {
+    if (this->numSlots == 0) return true;
+    // cohort taskId is in the last age class, its last time step, at time taskId
+    int lastTime = std::min(taskId, this->numTimeSteps - 1);
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return lastTime < this->nextTime + this->numSlots;
+}
+
+void
+SeapodymOutputSink::start() {
+
+    // DYM2 header: tag, function Id, min/max values, nlon, nlat, nlevel, first and last
+    // dates, longitude and latitude of each cell, dates, mask
+    std::size_t numCells = (std::size_t) this->nbi * this->nbj;
+    std::vector<float> xlon(numCells), ylat(numCells), zlevel(this->numTimeSteps);
+    std::vector<int> imask(numCells);
+    for (int j = 0; j < this->nbj; ++j) {
+        for (int i = 0; i < this->nbi; ++i) {
+            xlon[j * this->nbi + i] = this->lon[i];
+            ylat[j * this->nbi + i] = this->lat[j];
+            imask[j * this->nbi + i] = this->mask[i * this->nbj + j];
+        }
+    }
+    for (int t = 0; t < this->numTimeSteps; ++t) zlevel[t] = float(this->t0 + t * this->dt);
+    float tfin = zlevel.empty() ? float(this->t0) : zlevel.back();
+
+    for (Variable& var : this->variables) {
+        int idFunc = 0;
+        float minVal = 0, maxVal = 0;
+        int nlon = this->nbi, nlat = this->nbj, nlevel = this->numTimeSteps;
+        float tBeg = float(this->t0);
+        var.file.write("DYM2", 4);
+        var.file.write(reinterpret_cast<const char*>(&idFunc), sizeof(int));
+        var.file.write(reinterpret_cast<const char*>(&minVal), sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(&maxVal), sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(&nlon), sizeof(int));
+        var.file.write(reinterpret_cast<const char*>(&nlat), sizeof(int));
+        var.file.write(reinterpret_cast<const char*>(&nlevel), sizeof(int));
+        var.file.write(reinterpret_cast<const char*>(&tBeg), sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(&tfin), sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(xlon.data()), numCells * sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(ylat.data()), numCells * sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(zlevel.data()), zlevel.size() * sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(imask.data()), numCells * sizeof(int));
+        var.buffer.reserve(this->bufferBytes + numCells * sizeof(float));
+    }
+
+    if (!this->collector.isInEpoch()) {
+        this->collector.startEpoch();
+        this->ownEpoch = true;
+    }
+    this->thread = std::thread(&SeapodymOutputSink::loop, this);
+}
+
+void
+SeapodymOutputSink::notify(int taskId, int step) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->queue.push_back({taskId, step});
+    }
+    this->cond.notify_one();
+}
+
+void
+SeapodymOutputSink::loop() {
+
+    // no notification would wake this thread up
+    if (this->numTimeSteps <= 0) return;
+
+    std::vector<std::array<int, 2> > steps;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->cond.wait(lock, [this]() { return !this->queue.empty(); });
+            steps.assign(this->queue.begin(), this->queue.end());
+            this->queue.clear();
+        }
+
+        for (const auto& [taskId, step] : steps) {
+            int t = taskId + step - this->numAgeGroups + 1;
+            if (t >= 0 && t < this->numTimeSteps) ++this->numCompleted[t];
+        }
+
+        // the time steps are appended in order
+        int t = this->nextTime;
+        while (t < this->numTimeSteps && this->numCompleted[t] == this->numAgeGroups) {
+            this->writeTimeStep(t);
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->nextTime = ++t;
+        }
+        if (t == this->numTimeSteps) break;
+    }
+}
+
+void
+SeapodymOutputSink::writeTimeStep(int t) {
+
+    double tic = MPI_Wtime();
+
+    // make the puts of the workers visible in local memory
+    this->collector.sync();
+
+    std::size_t numCells = (std::size_t) this->nbi * this->nbj;
+    std::vector<double> field(numCells);
+    std::vector<float> record(numCells);
+    for (Variable& var : this->variables) {
+
+        std::fill(field.begin(), field.end(), 0.0);
+        for (int age = var.ageBeg; age < var.ageEnd; ++age) {
+            int taskId = t + this->numAgeGroups - 1 - age;
+            const double* chunk = this->collector.getChunkPtr(this->chunkFunc(taskId, age));
+            for (std::size_t k = 0; k < numCells; ++k) field[k] += chunk[k];
+        }
+
+        // (i, j) -> (j, i)
+        for (int i = 0; i < this->nbi; ++i) {
+            for (int j = 0; j < this->nbj; ++j) {
+                float value = float(field[i * this->nbj + j]);
+                record[j * this->nbi + i] = value;
+                var.minVal = std::min(var.minVal, value);
+                var.maxVal = std::max(var.maxVal, value);
+            }
+        }
+
+        const char* bytes = reinterpret_cast<const char*>(record.data());
+        var.buffer.insert(var.buffer.end(), bytes, bytes + numCells * sizeof(float));
+        if (var.buffer.size() >= this->bufferBytes) this->flush(var);
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->writeTime += MPI_Wtime() - tic;
+}
+
+void
+SeapodymOutputSink::flush(Variable& var) {
+    var.file.write(var.buffer.data(), var.buffer.size());
+    var.buffer.clear();
+}
+
+void
+SeapodymOutputSink::finish() {
+
+    if (!this->thread.joinable()) return;
+    this->thread.join();
+    if (this->ownEpoch) {
+        this->collector.endEpoch();
+        this->ownEpoch = false;
+    }
+
+    // patch the min/max values of the headers
+    for (Variable& var : this->variables) {
+        this->flush(var);
+        var.file.seekp(8);
+        var.file.write(reinterpret_cast<const char*>(&var.minVal), sizeof(float));
+        var.file.write(reinterpret_cast<const char*>(&var.maxVal), sizeof(float));
+        var.file.close();
+    }
+}
+
+std::vector<float>
+SeapodymOutputSink::readDymRecord(const std::string& filename, int level, int& nlon, int& nlat) {
+    std::ifstream file(filename, std::ios::binary);
+    char tag[4];
+    int idFunc, nlevel;
+    float minVal, maxVal;
+    file.read(tag, 4);
+    if (!file || std::strncmp(tag, "DYM2", 4) != 0) {
+        throw std::runtime_error("SeapodymOutputSink: " + filename + " is not a DYM2 file");
+    }
+    file.read(reinterpret_cast<char*>(&idFunc), sizeof(int));
+    file.read(reinterpret_cast<char*>(&minVal), sizeof(float));
+    file.read(reinterpret_cast<char*>(&maxVal), sizeof(float));
+    file.read(reinterpret_cast<char*>(&nlon), sizeof(int));
+    file.read(reinterpret_cast<char*>(&nlat), sizeof(int));
+    file.read(reinterpret_cast<char*>(&nlevel), sizeof(int));
+
+    // skip the dates, coordinates, levels and mask
+    std::size_t numCells = (std::size_t) nlon * nlat;
+    std::streamoff offset = 4 + 8 * 4 + (std::streamoff) (3 * numCells + nlevel) * 4
+                          + (std::streamoff) level * numCells * sizeof(float);
+    std::vector<float> record(numCells);
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(record.data()), numCells * sizeof(float));
+    if (!file) throw std::runtime_error("SeapodymOutputSink: cannot read record of " + filename);
+    return record;
+}
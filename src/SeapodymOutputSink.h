@@ -0,0 +1,241 @@
+#include <mpi.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <array>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "DistDataCollector.h"
+
+#ifndef SEAPODYM_OUTPUT_SINK
+#define SEAPODYM_OUTPUT_SINK
+
+/**
+ * Class SeapodymOutputSink
+ * @brief Streams the cohort fields to DYM files as the steps complete, on a thread of
+ *        the rank holding the DistDataCollector (the manager).
+ *
+ * @details The manager forwards the step completions to notify (see
+ *          TaskStepManager::setStepListener). Once all the age groups of a time step have
+ *          completed, the sink thread sums the chunks of each variable's age range into a
+ *          (nbi x nbj) field and appends it as a DYM record; the time steps are written in
+ *          order. Records go through a write-behind buffer of setBufferSize bytes per file,
+ *          so that the output overlaps with the computation instead of being written from
+ *          the main loop at the end of the run (SaveCohortsDym, WriteAVariableDym).
+ *
+ *          Cohort task_id at step s has age s at time task_id + s - numAgeGroups + 1
+ *          (SeapodymCohortDependencyAnalyzer). The fields are stored in row major order
+ *          (i * nbj + j) in the chunks and transposed to the DYM (nlat, nlon) order. The
+ *          minimum and maximum values of the header are patched when the file is closed.
+ *
+ *          By default the collector holds the chunks of all the time steps until the end of
+ *          the run, whether or not they are written. With setNumSlots, it holds a rolling
+ *          window of numSlots time steps instead: the chunks of time t are reused by time
+ *          t + numSlots (chunkFunc), writing time t frees its slot, and canDispatch, given
+ *          to TaskStepManager::setDispatchGate, holds back the cohorts that would write a
+ *          time step whose slot is not free yet.
+ */
+class SeapodymOutputSink {
+
+    private:
+
+        // output variable, sum of the age groups [ageBeg, ageEnd)
+        struct Variable {
+            std::string name;
+            int ageBeg, ageEnd;
+            std::ofstream file;
+            std::vector<char> buffer;
+            float minVal, maxVal;
+        };
+
+        // collected data, read on its root rank
+        DistDataCollector& collector;
+
+        // chunk Id of (task Id, step)
+        std::function<std::size_t(int, int)> chunkFunc;
+
+        int numAgeGroups;
+        int numTimeSteps;
+
+        // grid
+        int nbi, nbj;
+        std::vector<float> lon, lat;
+        std::vector<int> mask;
+
+        // date of the first time step and time step, in years
+        double t0 = 0, dt = 1;
+
+        // write-behind buffer size per file, in bytes
+        std::size_t bufferBytes = 1 << 22;
+
+        std::vector<Variable> variables;
+
+        // number of completed age groups of each time step
+        std::vector<int> numCompleted;
+
+        // next time step to write
+        int nextTime = 0;
+
+        // number of time steps held by the collector, 0 if all
+        int numSlots = 0;
+
+        // pending notifications, (task Id, step)
+        std::deque<std::array<int, 2> > queue;
+        std::mutex mutex;
+        std::condition_variable cond;
+
+        std::thread thread;
+
+        // time spent writing, seconds, guarded by mutex
+        double writeTime = 0;
+
+        // whether start opened the epoch of the collector, closed by finish
+        bool ownEpoch = false;
+
+        /**
+         * Sink thread, consume the notifications until all time steps are written
+         */
+        void loop();
+
+        /**
+         * Aggregate and append the records of a time step
+         * @param t time index
+         */
+        void writeTimeStep(int t);
+
+        /**
+         * Write the buffered records of a variable to its file
+         */
+        void flush(Variable& var);
+
+    public:
+
+        /**
+         * Constructor
+         * @param collector data collector holding one (nbi x nbj) field per chunk
+         * @param chunkFunc chunk Id of a (task Id, step)
+         * @param numAgeGroups number of age groups
+         * @param numTimeSteps number of time steps
+         * @param nbi number of cells along longitude
+         * @param nbj number of cells along latitude
+         */
+        SeapodymOutputSink(DistDataCollector& collector,
+                           std::function<std::size_t(int, int)> chunkFunc,
+                           int numAgeGroups, int numTimeSteps, int nbi, int nbj);
+
+        /**
+         * Destructor, waits for the thread
+         */
+        ~SeapodymOutputSink() { this->finish(); }
+
+        SeapodymOutputSink(const SeapodymOutputSink&) = delete;
+        SeapodymOutputSink& operator=(const SeapodymOutputSink&) = delete;
+
+        /**
+         * Add an output variable, e.g. juvenile, young, recruit, adult or total_pop
+         * @param name variable name
+         * @param ageBeg first age group (inclusive)
+         * @param ageEnd last age group (exclusive)
+         * @param filename DYM file, created or overwritten
+         */
+        void addVariable(const std::string& name, int ageBeg, int ageEnd, const std::string& filename);
+
+        /**
+         * Set the grid coordinates and the land mask written in the headers, by default
+         * the cell indices and all ocean
+         * @param lon nbi longitudes
+         * @param lat nbj latitudes
+         * @param mask nbi * nbj values in row major order, 0 on land
+         */
+        void setGrid(const std::vector<double>& lon, const std::vector<double>& lat,
+                     const std::vector<int>& mask);
+
+        /**
+         * Set the dates of the records
+         * @param t0 date of the first time step, in years
+         * @param dt time step, in years
+         */
+        void setDates(double t0, double dt) {
+            this->t0 = t0;
+            this->dt = dt;
+        }
+
+        /**
+         * Set the size of the write-behind buffer of each file
+         * @param bytes size, the records are written once it is exceeded
+         */
+        void setBufferSize(std::size_t bytes) {
+            this->bufferBytes = bytes;
+        }
+
+        /**
+         * Hold a rolling window of time steps in the collector rather than all of them
+         * @param numSlots number of time steps whose chunks the collector holds, at least
+         *                 numAgeGroups (the time steps of a cohort), 0 for all. chunkFunc
+         *                 must give time t and time t + numSlots the same chunks
+         * @throw std::invalid_argument if numSlots is negative or less than numAgeGroups
+         */
+        void setNumSlots(int numSlots);
+
+        /**
+         * Whether a cohort may be dispatched, i.e. all the time steps it writes have a free
+         * slot, thread safe. Always true without setNumSlots
+         * @param taskId task Id (cohort Id of SeapodymCohortDependencyAnalyzer)
+         * @return true if the slots of the cohort are free
+         */
+        bool canDispatch(int taskId);
+
+        /**
+         * Write the headers and start the sink thread, before the steps are executed. The
+         * collector is put in an epoch (DistDataCollector::startEpoch) until finish, unless
+         * it already is, so that the chunks can be synced before they are read
+         */
+        void start();
+
+        /**
+         * Notify the completion of a step, thread safe
+         * @param taskId task Id
+         * @param step step index
+         */
+        void notify(int taskId, int step);
+
+        /**
+         * Wait until all time steps are written, then close the files
+         */
+        void finish();
+
+        /**
+         * Get the number of time steps written so far
+         * @return number
+         */
+        int getNumWritten() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            return this->nextTime;
+        }
+
+        /**
+         * Get the time spent aggregating and writing, in seconds
+         * @return time
+         */
+        double getWriteTime() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            return this->writeTime;
+        }
+
+        /**
+         * Read a record of a DYM file, e.g. to check the output
+         * @param filename DYM file
+         * @param level record index
+         * @param nlon set to the number of longitudes
+         * @param nlat set to the number of latitudes
+         * @return nlat * nlon values
+         */
+        static std::vector<float> readDymRecord(const std::string& filename, int level, int& nlon, int& nlat);
+
+};
+
+#endif // SEAPODYM_OUTPUT_SINK
@@ -5,5 +5,8 @@
 #define END_TASK_TAG 1
 #define WORKER_AVAILABLE_TAG 2
 #define SHUTDOWN_TAG 3
+#define RESUME_TASK_TAG 4
+#define CANCEL_TASK_TAG 5
+#define PREPARE_TASK_TAG 6
 
 #endif
\ No newline at end of file
@@ -1,31 +1,9 @@
 #include "TaskDependencyManager.h"
 #include "Tags.h"
-#include <set>
+#include "TaskDependencyTracker.h"
 #include <vector>
 #include <iostream>
 
-bool isReady(int taskId, const std::map<int, std::set<int> >& dependencies, const std::set<int>& completed) {
-    for (int dep : dependencies.at(taskId)) {
-        if (completed.find(dep) == completed.end()) {
-            return false;
-        }
-    }
-    return true;
-}
-
-std::vector<int>
-getReadyTasks(const std::map<int, std::set<int> >& dependencies,
-                            const std::set<int>& completed,
-                            const std::set<int>& assigned) {
-    std::vector<int> ready;
-    for (const auto& [taskId, deps] : dependencies) {
-        if (assigned.find(taskId) == assigned.end() && isReady(taskId, dependencies, completed)) {
-            ready.push_back(taskId);
-        }
-    }
-    return ready;
-}
-
 TaskDependencyManager::TaskDependencyManager(MPI_Comm comm, int numTasks) {
 
     this->comm = comm;
@@ -45,42 +23,41 @@ TaskDependencyManager::run() const {
     int ier = MPI_Comm_size(this->comm, &size);
     const int numWorkers = size - 1;
 
-    std::set<int> completed;
-    std::set<int> assigned;
     std::map<int, int> results;
+    TaskDependencyTracker tracker(this->deps);
 
-    std::vector<int> ready = getReadyTasks(this->deps, completed, assigned);
+    // workers waiting for a task
+    std::vector<int> idleWorkers;
+    for (int workerId = size - 1; workerId >= 1; --workerId) idleWorkers.push_back(workerId);
 
-    // Initial assignment
-    for (int workerId = 1; workerId < size && !ready.empty(); ++ workerId) {
-        int taskId = ready.back(); 
-        ready.pop_back();
-        MPI_Send(&taskId, 1, MPI_INT, workerId, START_TASK_TAG, this->comm);
-        assigned.insert(taskId);
-    }
+    // Assign the ready tasks to the idle workers
+    auto assign = [&]() {
+        while (tracker.hasReady() && !idleWorkers.empty()) {
+            int taskId = tracker.popReady();
+            int workerId = idleWorkers.back();
+            idleWorkers.pop_back();
+            MPI_Send(&taskId, 1, MPI_INT, workerId, START_TASK_TAG, this->comm);
+        }
+    };
+    assign();
 
     // Receive the results and reassign new tasks
-    int res;
-    while (completed.size() < this->numTasks) {
+    int output[2];
+    while (tracker.getNumCompleted() < (std::size_t) this->numTasks) {
         MPI_Status status;
-        MPI_Recv(&res, 1, MPI_INT, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        MPI_Recv(output, 2, MPI_INT, MPI_ANY_SOURCE, END_TASK_TAG, this->comm, &status);
         int workerId = status.MPI_SOURCE;
-        int taskId = status.MPI_TAG;
-        results.insert( std::pair<int, int>(taskId, res) );
-        completed.insert(taskId);
+        int taskId = output[0];
+        results.insert( std::pair<int, int>(taskId, output[1]) );
+        tracker.complete(taskId);
+        idleWorkers.push_back(workerId);
 
-        std::cout << "Tasks completed so far: ";
-        for (auto tid : completed) std::cout << tid << ", ";
-        std::cout << std::endl;
-
-        ready = getReadyTasks(this->deps, completed, assigned);
-
-        if (!ready.empty()) {
-            int nextTaskId = ready.back(); 
-            ready.pop_back();
-            MPI_Send(&nextTaskId, 1, MPI_INT, workerId, START_TASK_TAG, MPI_COMM_WORLD);
-            assigned.insert(nextTaskId);
+        if (this->verbose) {
+            std::cout << "Tasks completed so far: " << tracker.getNumCompleted()
+                      << '/' << this->numTasks << std::endl;
         }
+
+        assign();
     }
 
     // Shutdown
@@ -25,6 +25,9 @@ class TaskDependencyManager {
         // dependencies
         std::map<int, std::set<int> > deps;
 
+        // whether to print the progress
+        bool verbose = false;
+
     public:
 
         /**
@@ -42,7 +45,14 @@ class TaskDependencyManager {
         void addDependencies(int taskId, const std::set<int>& otherTaskIds);
 
         /**
-         * Run the manager
+         * Print the number of completed tasks after each completion
+         * @param verbose true to print
+         */
+        void setVerbose(bool verbose) { this->verbose = verbose; }
+
+        /**
+         * Run the manager. The ready tasks are tracked incrementally (see
+         * TaskDependencyTracker), so that each completion costs O(number of dependents).
          * @return the result of each task
          */
         std::map<int, int> run() const;
@@ -0,0 +1,22 @@
+#include "TaskDependencyTracker.h"
+
+TaskDependencyTracker::TaskDependencyTracker(const std::map<int, std::set<int> >& dependencies) {
+
+    this->remaining.reserve(dependencies.size());
+    for (const auto& [taskId, deps] : dependencies) {
+        this->remaining[taskId] = (int) deps.size();
+        for (int dep : deps) this->dependents[dep].push_back(taskId);
+        if (deps.empty()) this->readyQueue.push_back(taskId);
+    }
+}
+
+void
+TaskDependencyTracker::complete(int taskId) {
+
+    ++this->numCompleted;
+    auto it = this->dependents.find(taskId);
+    if (it == this->dependents.end()) return;
+    for (int dependent : it->second) {
+        if (--this->remaining.at(dependent) == 0) this->readyQueue.push_back(dependent);
+    }
+}
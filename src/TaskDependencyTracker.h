@@ -0,0 +1,82 @@
+#include <map>
+#include <set>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstddef>
+
+#ifndef TASK_DEPENDENCY_TRACKER
+#define TASK_DEPENDENCY_TRACKER
+
+/**
+ * Class TaskDependencyTracker
+ * @brief Event driven ready set of a task graph. Each task keeps the number of its
+ *        dependencies not yet complete and each task knows its dependents, so that
+ *        completing a task costs O(number of dependents) rather than a scan of all
+ *        the tasks.
+ * @see TaskDependencyManager
+ */
+
+class TaskDependencyTracker {
+
+    private:
+
+        // task Id -> number of dependencies not yet complete
+        std::unordered_map<int, int> remaining;
+
+        // task Id -> tasks that depend on it
+        std::unordered_map<int, std::vector<int> > dependents;
+
+        // tasks whose dependencies are complete and which have not been popped yet
+        std::deque<int> readyQueue;
+
+        // number of completed tasks
+        std::size_t numCompleted = 0;
+
+    public:
+
+        /**
+         * Constructor
+         * @param dependencies task Id -> Ids of the tasks it depends on, the tasks
+         *                     without dependencies are ready
+         */
+        TaskDependencyTracker(const std::map<int, std::set<int> >& dependencies);
+
+        /**
+         * Mark a task as complete, its dependents whose dependencies are now all
+         * complete become ready
+         * @param taskId task Id
+         */
+        void complete(int taskId);
+
+        /**
+         * Check whether a task is ready
+         * @return true if popReady can be called
+         */
+        bool hasReady() const { return !this->readyQueue.empty(); }
+
+        /**
+         * Take the next ready task, in the order in which the tasks became ready
+         * @return task Id
+         */
+        int popReady() {
+            int taskId = this->readyQueue.front();
+            this->readyQueue.pop_front();
+            return taskId;
+        }
+
+        /**
+         * Get the number of ready tasks
+         * @return number
+         */
+        std::size_t getNumReady() const { return this->readyQueue.size(); }
+
+        /**
+         * Get the number of completed tasks
+         * @return number
+         */
+        std::size_t getNumCompleted() const { return this->numCompleted; }
+
+};
+
+#endif // TASK_DEPENDENCY_TRACKER
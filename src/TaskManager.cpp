@@ -1,5 +1,8 @@
 #include "TaskManager.h"
 #include "Tags.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
 
 TaskManager::TaskManager(MPI_Comm comm, int numTasks) {
 
@@ -7,50 +10,97 @@ TaskManager::TaskManager(MPI_Comm comm, int numTasks) {
     this->numTasks = numTasks;
 }
 
-std::map<int, int>
-TaskManager::run() const {
+void
+TaskManager::farm(const std::function<int()>& receive) const {
 
     const int shutdown = -1;
     int size;
-    int ier = MPI_Comm_size(this->comm, &size);
+    MPI_Comm_size(this->comm, &size);
     const int numWorkers = size - 1;
     int task_id = 0;
-    int res;
-    
+
+    // send the next range of tasks, or the shutdown signal if there are none left
+    auto sendNext = [&](int rank) {
+        if (task_id >= this->numTasks) {
+            MPI_Send(&shutdown, 1, MPI_INT, rank, START_TASK_TAG, this->comm);
+            return false;
+        }
+        int remaining = this->numTasks - task_id;
+        int n = this->chunkSize;
+        if (this->policy == CHUNK_GUIDED) {
+            n = std::max(n, (remaining + numWorkers - 1) / numWorkers);
+        }
+        int range[2] = {task_id, task_id + std::min(n, remaining)};
+        MPI_Send(range, 2, MPI_INT, rank, START_TASK_TAG, this->comm);
+        task_id = range[1];
+        return true;
+    };
+
     // initial distribution of tasks
+    int numBusy = 0;
     for (int rank = 1; rank < numWorkers + 1; ++rank) {
-        if (task_id >= 0 && task_id <= this->numTasks) {
-            ier = MPI_Send(&task_id, 1, MPI_INT, rank, START_TASK_TAG, this->comm);
-            ++task_id;
-        }  
+        if (sendNext(rank)) ++numBusy;
     }
 
     // collect and reassign tasks
-    std::map<int, int> results;
-    while (task_id < this->numTasks) {
-
-        MPI_Status status;
-        ier = MPI_Recv(&res, 1, MPI_INT, MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &status);
-        int taskId = status.MPI_TAG;
-        results.insert( std::pair<int, int>(taskId, res) );
-
-        // send the next task
-        ier = MPI_Send(&task_id, 1, MPI_INT, status.MPI_SOURCE, START_TASK_TAG, this->comm);
-
-        ++task_id;
+    while (numBusy > 0) {
+        int source = receive();
+        if (!sendNext(source)) --numBusy;
     }
+}
 
-    // finish up
-    for (int rank = 1; rank < numWorkers + 1; ++rank) {
+std::map<int, int>
+TaskManager::run() const {
 
+    std::map<int, int> results;
+    std::vector<int> buffer;
+    this->farm([&]() {
         MPI_Status status;
-        ier = MPI_Recv(&res, 1, MPI_INT, MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &status);
-        int taskId = status.MPI_TAG;
-        results.insert( std::pair<int, int>(taskId, res) );
+        MPI_Probe(MPI_ANY_SOURCE, END_TASK_TAG, this->comm, &status);
+        int count;
+        MPI_Get_count(&status, MPI_INT, &count);
+        buffer.resize(count);
+        MPI_Recv(buffer.data(), count, MPI_INT, status.MPI_SOURCE, END_TASK_TAG,
+                 this->comm, MPI_STATUS_IGNORE);
+        int begin = buffer[0];
+        for (int i = 1; i < count; ++i) {
+            results.insert( std::pair<int, int>(begin + i - 1, buffer[i]) );
+        }
+        return status.MPI_SOURCE;
+    });
+    return results;
+}
 
-        // send shutdown signal
-        ier = MPI_Send(&shutdown, 1, MPI_INT, status.MPI_SOURCE, START_TASK_TAG, this->comm);
-    }
+void
+TaskManager::run(const std::function<void(int, const double*, int)>& handler) const {
 
-    return results;
+    // doubles so that the payloads are aligned, see TaskWorker for the layout
+    std::vector<double> buffer;
+    this->farm([&]() {
+        MPI_Message message;
+        MPI_Status status;
+        MPI_Mprobe(MPI_ANY_SOURCE, END_TASK_TAG, this->comm, &message, &status);
+        int numBytes;
+        MPI_Get_count(&status, MPI_BYTE, &numBytes);
+        std::size_t numDoubles = (numBytes + sizeof(double) - 1) / sizeof(double);
+        if (buffer.size() < numDoubles) buffer.resize(numDoubles);
+        MPI_Mrecv(buffer.data(), numBytes, MPI_BYTE, &message, MPI_STATUS_IGNORE);
+
+        // records of {int taskId, int numValues, numValues doubles}, numValues < 0 if the
+        // payload was written into a collector
+        const double* record = buffer.data();
+        const double* end = buffer.data() + numDoubles;
+        while (record < end) {
+            int header[2];
+            std::memcpy(header, record, sizeof(header));
+            ++record;
+            if (header[1] < 0) {
+                handler(header[0], nullptr, 0);
+            } else {
+                handler(header[0], record, header[1]);
+                record += header[1];
+            }
+        }
+        return status.MPI_SOURCE;
+    });
 }
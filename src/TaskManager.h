@@ -1,5 +1,6 @@
 #include <mpi.h>
 #include <map>
+#include <functional>
 
 #ifndef TASK_MANAGER
 #define TASK_MANAGER
@@ -8,11 +9,28 @@
  * Class TaskManager
  * @brief The TaskManager assigns tasks to TaskWorkers. In this simple version of task farming, there are no dependencies 
  *        between tasks. Use this in conjunction with TaskWorker when the tasks can be performed in any order. 
+ *
+ * @details The tasks are handed out as [begin, end) ranges and each worker returns the results of a
+ *          range in one message, {begin, result_begin, ..., result_end-1}. By default a range holds
+ *          one task; for short tasks, larger (CHUNK_FIXED) or shrinking (CHUNK_GUIDED) ranges
+ *          amortize the message latency.
+ *
+ *          Workers constructed with a payload function return an arbitrary number of doubles per
+ *          task instead of an int, see run(handler). The task Id travels in the payload, not in
+ *          the tag, so the number of tasks is not bounded by MPI_TAG_UB.
  * @see TaskWorker
  */
 
 class TaskManager {
 
+    public:
+
+        // how the size of the ranges is chosen
+        enum ChunkPolicy {
+            CHUNK_FIXED,  // chunkSize tasks per range
+            CHUNK_GUIDED  // remaining tasks / number of workers, but at least chunkSize
+        };
+
     private:
 
         // Communicator
@@ -21,6 +39,18 @@ class TaskManager {
         // number of tasks
         int numTasks;
 
+        // range size policy
+        ChunkPolicy policy = CHUNK_FIXED;
+
+        // (minimum) number of tasks per range
+        int chunkSize = 1;
+
+        /**
+         * Hand out the ranges of tasks until all the tasks are done
+         * @param receive receives and processes one message of results, returns the source rank
+         */
+        void farm(const std::function<int()>& receive) const;
+
     public:
 
         /**
@@ -30,12 +60,33 @@ class TaskManager {
          */
         TaskManager(MPI_Comm comm, int numTasks);
 
+        /**
+         * Set the number of tasks sent at once
+         * @param policy CHUNK_FIXED or CHUNK_GUIDED
+         * @param chunkSize number of tasks per range (CHUNK_FIXED) or minimum number of tasks
+         *                  per range (CHUNK_GUIDED), >= 1
+         */
+        void setChunking(ChunkPolicy policy, int chunkSize) {
+            this->policy = policy;
+            this->chunkSize = chunkSize < 1 ? 1 : chunkSize;
+        }
+
         /**
          * Run the manager
          * @return results of each task
          */
         std::map<int, int> run() const;
 
+        /**
+         * Run the manager with workers returning payloads (see TaskWorker). The messages are
+         * matched with MPI_Mprobe and received with MPI_Mrecv into a buffer that is reused
+         * across messages and only grows.
+         * @param handler called for each task with the task Id, a pointer to the payload and its
+         *                number of values. The pointer is only valid during the call. It is
+         *                nullptr if the worker wrote the payload into a DistDataCollector chunk.
+         */
+        void run(const std::function<void(int, const double*, int)>& handler) const;
+
 };
 
 #endif // TASK_MANAGER
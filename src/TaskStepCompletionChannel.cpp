@@ -0,0 +1,68 @@
+#include "TaskStepCompletionChannel.h"
+#include "Tags.h"
+
+TaskStepCompletionChannel::TaskStepCompletionChannel(MPI_Comm comm,
+    const std::vector<int>& workers, int depth) {
+
+    this->comm = comm;
+    std::size_t n = workers.size() * (depth + 1);
+    this->requests.resize(n, MPI_REQUEST_NULL);
+    this->buffers.resize(n);
+    this->sources.reserve(n);
+    this->tags.reserve(n);
+    this->indices.resize(n);
+    this->statuses.resize(n);
+
+    std::size_t i = 0;
+    for (int worker : workers) {
+        for (int j = 0; j < depth; ++j, ++i) {
+            MPI_Recv_init(this->buffers[i].data(), 3, MPI_INT, worker, END_TASK_TAG,
+                          comm, &this->requests[i]);
+            this->sources.push_back(worker);
+            this->tags.push_back(END_TASK_TAG);
+        }
+        MPI_Recv_init(this->buffers[i].data(), 1, MPI_INT, worker, WORKER_AVAILABLE_TAG,
+                      comm, &this->requests[i]);
+        this->sources.push_back(worker);
+        this->tags.push_back(WORKER_AVAILABLE_TAG);
+        ++i;
+    }
+    MPI_Startall((int) n, this->requests.data());
+}
+
+TaskStepCompletionChannel::~TaskStepCompletionChannel() {
+    this->free();
+}
+
+int
+TaskStepCompletionChannel::poll(std::vector<TaskStepCompletion>& completions, bool blocking) {
+
+    int outcount = 0;
+    if (blocking) {
+        MPI_Waitsome((int) this->requests.size(), this->requests.data(), &outcount,
+                     this->indices.data(), this->statuses.data());
+    } else {
+        MPI_Testsome((int) this->requests.size(), this->requests.data(), &outcount,
+                     this->indices.data(), this->statuses.data());
+    }
+    if (outcount == MPI_UNDEFINED) return 0;
+
+    for (int k = 0; k < outcount; ++k) {
+        int i = this->indices[k];
+        completions.push_back(TaskStepCompletion{this->sources[i], this->tags[i], this->buffers[i]});
+        // repost the receive
+        MPI_Start(&this->requests[i]);
+    }
+    return outcount;
+}
+
+void
+TaskStepCompletionChannel::free() {
+    for (auto& req : this->requests) {
+        if (req != MPI_REQUEST_NULL) {
+            MPI_Cancel(&req);
+            MPI_Wait(&req, MPI_STATUS_IGNORE);
+            MPI_Request_free(&req);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#include <mpi.h>
+#include <array>
+#include <vector>
+
+#ifndef TASK_STEP_COMPLETION_CHANNEL
+#define TASK_STEP_COMPLETION_CHANNEL
+
+/**
+ * @brief A message received by TaskStepCompletionChannel
+ */
+struct TaskStepCompletion {
+    // rank of the worker
+    int source;
+    // END_TASK_TAG or WORKER_AVAILABLE_TAG
+    int tag;
+    // {taskId, step, result} for END_TASK_TAG
+    std::array<int, 3> data;
+};
+
+/**
+ * Class TaskStepCompletionChannel
+ * @brief Receives the END_TASK_TAG and WORKER_AVAILABLE_TAG messages of the workers into
+ *        pre-posted persistent receives.
+ *
+ * @details Each worker has depth persistent receives for END_TASK_TAG and one for
+ *          WORKER_AVAILABLE_TAG, created with MPI_Recv_init and started with MPI_Startall.
+ *          Since the receives are posted before the messages arrive, the messages are
+ *          matched without probing and without the unexpected message copy of the
+ *          MPI_Iprobe + MPI_Recv pattern. A completed receive is restarted right after
+ *          its data have been copied out.
+ *
+ *          The messages of a worker may be returned out of order when several of them
+ *          complete in the same call. TaskStepManager holds back the steps received
+ *          ahead of the next expected step of their task and processes them in order.
+ *
+ * @see TaskStepManager::setCompletionDepth
+ */
+class TaskStepCompletionChannel {
+
+    private:
+
+        // communicator
+        MPI_Comm comm;
+
+        // persistent requests
+        std::vector<MPI_Request> requests;
+
+        // receive buffers, one per request
+        std::vector< std::array<int, 3> > buffers;
+
+        // source and tag of each request
+        std::vector<int> sources;
+        std::vector<int> tags;
+
+        // workspace for MPI_Waitsome/MPI_Testsome
+        std::vector<int> indices;
+        std::vector<MPI_Status> statuses;
+
+    public:
+
+        /**
+         * Constructor, creates and starts the persistent receives
+         * @param comm communicator
+         * @param workers ranks of the workers
+         * @param depth number of END_TASK_TAG receives posted per worker
+         */
+        TaskStepCompletionChannel(MPI_Comm comm, const std::vector<int>& workers, int depth);
+
+        /**
+         * Destructor, cancels and frees the pending receives
+         */
+        ~TaskStepCompletionChannel();
+
+        TaskStepCompletionChannel(const TaskStepCompletionChannel&) = delete;
+        TaskStepCompletionChannel& operator=(const TaskStepCompletionChannel&) = delete;
+
+        /**
+         * Get the completed messages
+         * @param completions completed messages (appended)
+         * @param blocking wait for at least one message if true (MPI_Waitsome), otherwise
+         *                 return immediately (MPI_Testsome)
+         * @return number of messages appended
+         */
+        int poll(std::vector<TaskStepCompletion>& completions, bool blocking);
+
+        /**
+         * Cancel and free the pending receives. Messages that have not been returned by
+         * poll are lost.
+         */
+        void free();
+
+};
+
+#endif // TASK_STEP_COMPLETION_CHANNEL
@@ -1,11 +1,20 @@
 #include "TaskStepManager.h"
 #include "Tags.h"
+#include "Trace.h"
+#include "TaskStepCompletionChannel.h"
+#include "TaskStepPublisher.h"
 #include <set>
 #include <unordered_set>
 #include <list>
 #include <map>
+#include <vector>
 #include <algorithm>
 #include <iostream>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
 
 // Hash for std::array<int,2> so it can be used in unordered_set (O(1) lookups).
 struct DepHash {
@@ -26,8 +35,56 @@ TaskStepManager::TaskStepManager(MPI_Comm comm, int numTasks,
     this->deps = dependencyMap;
 }
 
+void
+TaskStepManager::setProfile(const TaskStepProfile& profile, double driftTolerance) {
+    this->expectedProfile = profile;
+    this->driftTolerance = driftTolerance;
+    this->priorities = profile.getPriorities(this->stepBegMap, this->stepEndMap, this->deps);
+}
+
+int
+TaskStepManager::chooseLocalWorker(const std::array<int, 2>& range,
+                                   const std::multiset<int>& freeWorkers,
+                                   const std::vector<int>& workerNodes,
+                                   const std::map<int, std::array<int, 2> >& nodeTimeRanges) {
+    int best = *freeWorkers.begin();
+    int bestOverlap = 0;
+    for (auto it = freeWorkers.begin(); it != freeWorkers.end(); it = freeWorkers.upper_bound(*it)) {
+        auto nr = nodeTimeRanges.find(workerNodes.at(*it));
+        if (nr == nodeTimeRanges.end()) continue;
+        int overlap = std::min(range[1], nr->second[1]) - std::max(range[0], nr->second[0]);
+        if (overlap > bestOverlap) {
+            best = *it;
+            bestOverlap = overlap;
+        }
+    }
+    return best;
+}
+
+std::vector<int>
+TaskStepManager::getNodeIds(MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    MPI_Comm shmComm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &shmComm);
+    // the node Id is the lowest rank on the node
+    int nodeId = rank;
+    MPI_Allreduce(MPI_IN_PLACE, &nodeId, 1, MPI_INT, MPI_MIN, shmComm);
+    std::vector<int> nodeIds(size);
+    MPI_Allgather(&nodeId, 1, MPI_INT, nodeIds.data(), 1, MPI_INT, comm);
+    MPI_Comm_free(&shmComm);
+    return nodeIds;
+}
+
 std::set< std::array<int, 3> >
-TaskStepManager::run() const {
+TaskStepManager::run() {
+
+    // the teams of TaskStepTeamWorker are grouped from rank 1, which assumes the manager
+    // rank runs no worker
+    if (this->colocated && this->teamSize > 1) {
+        throw std::invalid_argument("TaskStepManager: a colocated worker cannot be combined with teams");
+    }
 
     int size;
     MPI_Comm_size(this->comm, &size);
@@ -43,76 +100,463 @@ TaskStepManager::run() const {
     std::list<int> task_queue;
     for (const auto& [task_id, beg] : this->stepBegMap) task_queue.push_back(task_id);
 
-    std::set<int> active_workers;
-    for (int i = 1; i < size; ++i) active_workers.insert(i);
+    // Profile guided (longest remaining critical path first) or user given order,
+    // the tasks without a priority come last
+    bool usePriorities = !this->priorities.empty();
+    if (usePriorities) {
+        auto priority = [this](int task_id) {
+            auto it = this->priorities.find(task_id);
+            return it == this->priorities.end() ? 0.0 : it->second;
+        };
+        task_queue.sort([&priority](int a, int b) {
+            double pa = priority(a), pb = priority(b);
+            return pa > pb || (pa == pb && a < b);
+        });
+    }
+    const std::size_t minDriftSamples = 10;
+    double driftSum = 0;
+    std::size_t numDriftSamples = 0;
+
+    // time of the last event (dispatch or step completion) of each assigned task
+    this->measuredProfile = TaskStepProfile();
+    std::map<int, double> lastEventTime;
+
+    // free slots of the team leaders (every rank other than the manager if
+    // teamSize == 1), a worker appears once per free slot
+    int firstWorker = this->colocated ? 0 : 1;
+    std::multiset<int> active_workers;
+    for (int i = firstWorker; i < size; i += this->teamSize) {
+        for (int slot = 0; slot < this->numSlots; ++slot) active_workers.insert(i);
+    }
+
+    // each dispatched task is answered by one WORKER_AVAILABLE_TAG message
+    std::size_t numDispatched = 0;
+    std::size_t numReleased = 0;
 
     std::array<int, 3> output;
     MPI_Status status;
 
-    // Receive and process a single message whose tag was already probed.
-    auto processMessage = [&](const MPI_Status& st) {
-        if (st.MPI_TAG == END_TASK_TAG) {
-            MPI_Recv(output.data(), 3, MPI_INT, st.MPI_SOURCE, END_TASK_TAG,
-                     this->comm, MPI_STATUS_IGNORE);
-            results.insert(output);
+    // Speculation: ranks running each assigned task (the original and its duplicate)
+    bool useSpeculation = this->speculationSlowdown > 0 && !this->publisher &&
+                          this->completionDepth == 0 && this->numSlots == 1 && this->teamSize == 1;
+    std::map<int, std::vector<int> > taskRunners;
+    std::set<int> speculated;
+    std::map<int, int> nextStep;
+    double stepCostSum = 0;
+    std::size_t numStepCosts = 0;
+    this->numSpeculated = 0;
+
+    // Migration: relative speed of the workers and tasks being moved
+    bool useMigration = this->migrationFactor > 0 && !this->publisher &&
+                        this->completionDepth == 0 && this->numSlots == 1 && this->teamSize == 1;
+    std::map<int, std::array<double, 2> > stepIndexCosts; // step -> {sum, count}
+    std::map<int, std::array<double, 2> > workerCosts;    // rank -> {sum of costs, sum of step means}
+    std::map<int, int> migrationTargets;                  // task -> reserved worker
+    std::map<int, int> migrationSources;                  // cancelled worker -> task
+
+    // Early initialization: task -> worker reserved for it. Only TaskStepWorker handles
+    // PREPARE_TASK_TAG, the threaded and team workers would run the task twice
+    bool useEarlyInit = this->earlyInit && this->numSlots == 1 && this->teamSize == 1;
+    std::map<int, int> prepared;
+    this->numMigrated = 0;
+    auto slowness = [&](int worker) {
+        const auto& wc = workerCosts.at(worker);
+        return wc[0] / wc[1];
+    };
+
+    // Forcing locality: prefer the workers on the nodes that already hold the time
+    // range of a task. The range of a node spans the time ranges of its running tasks,
+    // or the last such range if the node is idle (its slabs are still loaded).
+    bool useLocality = !this->workerNodes.empty() && !this->timeRanges.empty();
+    std::map<int, std::multiset<int> > nodeBegs, nodeEnds;
+    std::map<int, int> taskNode;
+    this->nodeTimeRanges.clear();
+    auto updateNodeRange = [&](int node) {
+        if (nodeBegs[node].empty()) return;
+        std::array<int, 2> range = {*nodeBegs[node].begin(), *nodeEnds[node].rbegin()};
+        auto it = this->nodeTimeRanges.find(node);
+        if (it == this->nodeTimeRanges.end() || it->second != range) {
+            this->nodeTimeRanges[node] = range;
+            if (this->timeRangeListener) this->timeRangeListener(node, range[0], range[1]);
+        }
+    };
+    auto chooseWorker = [&](int task_id) {
+        if (!useLocality || !this->localityAssign) return *active_workers.begin();
+        return chooseLocalWorker(this->timeRanges.at(task_id), active_workers,
+                                 this->workerNodes, this->nodeTimeRanges);
+    };
+
+    // Process a received message
+    auto processCompletion = [&](int source, int tag, const std::array<int, 3>& output) {
+        if (tag == END_TASK_TAG) {
             int task_id = output[0];
             int step    = output[1];
+            // a step of a speculated task completes twice, the first one wins
+            if (completed.count({task_id, step}) > 0) return;
+            results.insert(output);
             completed.insert({task_id, step});
-            if (step == this->stepEndMap.at(task_id) - 1)
+            nextStep[task_id] = std::max(nextStep[task_id], step + 1);
+            if (this->stepListener) this->stepListener(task_id, step, output[2]);
+
+            double now = MPI_Wtime();
+            double cost = now - lastEventTime[task_id];
+            lastEventTime[task_id] = now;
+            this->measuredProfile.setCost(task_id, step, cost);
+            stepCostSum += cost;
+            ++numStepCosts;
+            if (useMigration && source >= 0) {
+                int stepIndex = step - this->stepBegMap.at(task_id);
+                auto& sc = stepIndexCosts[stepIndex];
+                sc[0] += cost;
+                sc[1] += 1;
+                auto& wc = workerCosts[source];
+                wc[0] += cost;
+                wc[1] += sc[0] / sc[1];
+            }
+            if (usePriorities && this->expectedProfile.size() > 0 &&
+                this->expectedProfile.getCost(task_id, step) > 0) {
+                double expected = this->expectedProfile.getCost(task_id, step);
+                driftSum += std::abs(cost - expected) / expected;
+                ++numDriftSamples;
+                if (numDriftSamples >= minDriftSamples &&
+                    driftSum / numDriftSamples > this->driftTolerance) {
+                    std::cout << "[Manager] step costs drifted from the profile by "
+                              << driftSum / numDriftSamples
+                              << ", reverting to dynamic scheduling\n";
+                    usePriorities = false;
+                    task_queue.sort();
+                }
+            }
+            if (step == this->stepEndMap.at(task_id) - 1) {
                 assigned.erase(task_id);
+                lastEventTime.erase(task_id);
+                if (useSpeculation || useMigration) {
+                    for (int runner : taskRunners[task_id]) {
+                        if (runner != source) {
+                            MPI_Send(&task_id, 1, MPI_INT, runner, CANCEL_TASK_TAG, this->comm);
+                        }
+                    }
+                    taskRunners.erase(task_id);
+                }
+                if (useLocality) {
+                    int node = taskNode.at(task_id);
+                    const auto& range = this->timeRanges.at(task_id);
+                    nodeBegs[node].erase(nodeBegs[node].find(range[0]));
+                    nodeEnds[node].erase(nodeEnds[node].find(range[1]));
+                    updateNodeRange(node);
+                }
+            }
         } else { // WORKER_AVAILABLE_TAG
-            int dummy;
-            MPI_Recv(&dummy, 1, MPI_INT, st.MPI_SOURCE, WORKER_AVAILABLE_TAG,
-                     this->comm, MPI_STATUS_IGNORE);
-            active_workers.insert(st.MPI_SOURCE);
+            active_workers.insert(source);
+            ++numReleased;
+            auto ms = migrationSources.find(source);
+            if (ms != migrationSources.end()) {
+                int task_id = ms->second;
+                int target = migrationTargets.at(task_id);
+                migrationSources.erase(ms);
+                migrationTargets.erase(task_id);
+                if (assigned.count(task_id) > 0) {
+                    // the task stopped at a step boundary, resume it on the reserved worker
+                    std::array<int, 2> resume = {task_id, nextStep.at(task_id)};
+                    MPI_Send(resume.data(), 2, MPI_INT, target, RESUME_TASK_TAG, this->comm);
+                    SEAPODYM_TRACE_EVENT(TRACE_DISPATCH, task_id, resume[1], target, 0);
+                    taskRunners[task_id] = {target};
+                    lastEventTime[task_id] = MPI_Wtime();
+                    ++this->numMigrated;
+                    ++numDispatched;
+                } else {
+                    // the task completed before the cancellation was seen
+                    active_workers.insert(target);
+                }
+            }
+        }
+    };
+
+    // Receive and process a single message whose tag was already probed.
+    auto processMessage = [&](const MPI_Status& st) {
+        int count = (st.MPI_TAG == END_TASK_TAG) ? 3 : 1;
+        MPI_Recv(output.data(), count, MPI_INT, st.MPI_SOURCE, st.MPI_TAG,
+                 this->comm, MPI_STATUS_IGNORE);
+        processCompletion(st.MPI_SOURCE, st.MPI_TAG, output);
+    };
+
+    // Optionally, receive the messages into pre-posted persistent receives
+    std::unique_ptr<TaskStepCompletionChannel> channel;
+    std::vector<TaskStepCompletion> completions;
+    if (this->completionDepth > 0) {
+        std::vector<int> workers;
+        for (int i = firstWorker; i < size; i += this->teamSize) workers.push_back(i);
+        channel = std::make_unique<TaskStepCompletionChannel>(this->comm, workers, this->completionDepth);
+    }
+    // Process the completed messages of the channel, returns true if there were any
+    // The channel may return the steps of a task out of order. A step received ahead
+    // of the next expected one is held back, so that the steps are processed in order
+    // and the step costs are charged to the right steps
+    std::map<int, std::map<int, TaskStepCompletion> > heldSteps; // task -> step -> completion
+    auto pollChannel = [&](bool blocking) {
+        completions.clear();
+        channel->poll(completions, blocking);
+        for (const auto& c : completions) {
+            if (c.tag != END_TASK_TAG) {
+                processCompletion(c.source, c.tag, c.data);
+                continue;
+            }
+            int task_id = c.data[0];
+            if (c.data[1] > nextStep[task_id]) {
+                heldSteps[task_id][c.data[1]] = c;
+                continue;
+            }
+            processCompletion(c.source, c.tag, c.data);
+            auto ht = heldSteps.find(task_id);
+            while (ht != heldSteps.end() && !ht->second.empty() &&
+                   ht->second.begin()->first <= nextStep[task_id]) {
+                TaskStepCompletion held = ht->second.begin()->second;
+                ht->second.erase(ht->second.begin());
+                processCompletion(held.source, held.tag, held.data);
+            }
+            if (ht != heldSteps.end() && ht->second.empty()) heldSteps.erase(ht);
+        }
+        return !completions.empty();
+    };
+
+    // Probe for END_TASK_TAG and WORKER_AVAILABLE_TAG messages. A colocated worker
+    // receives START_TASK_TAG messages on this rank, which must not be matched here
+    auto iprobe = [&](MPI_Status& st) {
+        int flag = 0;
+        if (this->colocated) {
+            MPI_Iprobe(MPI_ANY_SOURCE, END_TASK_TAG, this->comm, &flag, &st);
+            if (!flag) MPI_Iprobe(MPI_ANY_SOURCE, WORKER_AVAILABLE_TAG, this->comm, &flag, &st);
+        } else {
+            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &flag, &st);
+        }
+        return flag;
+    };
+
+    // Optionally, read the step completions from the board of the publisher
+    if (this->publisher) this->publisher->reset();
+    // Process the newly published steps, returns true if there were any
+    auto pollBoard = [&]() {
+        this->publisher->sync();
+        bool found = false;
+        std::vector<int> tasks(assigned.begin(), assigned.end());
+        for (int task_id : tasks) {
+            int& step = nextStep[task_id];
+            std::array<int, 3> out = {task_id, step, 0};
+            while (step < this->stepEndMap.at(task_id) &&
+                   this->publisher->isPublished(task_id, step, out[2])) {
+                out[1] = step++;
+                processCompletion(-1, END_TASK_TAG, out);
+                found = true;
+            }
         }
+        return found;
     };
 
     while (!task_queue.empty() || !assigned.empty()) {
 
         // --- Non-blocking drain: receive everything currently queued (both tags) ---
         bool received_any = false;
-        {
-            int flag = 0;
-            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &flag, &status);
+        if (this->publisher) {
+            while (pollBoard()) received_any = true;
+        }
+        if (channel) {
+            while (pollChannel(false)) received_any = true;
+        } else {
+            int flag = iprobe(status);
             while (flag) {
                 processMessage(status);
                 received_any = true;
-                MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &flag, &status);
+                flag = iprobe(status);
             }
         }
 
-        // --- Assign all ready tasks to available workers ---
+        // --- Assign all ready tasks to available workers (or to the worker that prepared them) ---
+        bool gated = false;
         for (auto it = task_queue.begin();
-             it != task_queue.end() && !active_workers.empty(); ) {
+             it != task_queue.end() && (!active_workers.empty() || !prepared.empty()); ) {
             int task_id = *it;
+            auto pw = prepared.find(task_id);
+            if (pw == prepared.end() && active_workers.empty()) {
+                ++it;
+                continue;
+            }
             const auto& task_deps = this->deps.at(task_id);
             bool ready = std::all_of(task_deps.begin(), task_deps.end(),
                 [&](const dep_type& d) { return completed.count(d) > 0; });
+            if (ready && this->dispatchGate && !this->dispatchGate(task_id)) {
+                ready = false;
+                gated = true;
+            }
             if (ready) {
-                int worker = *active_workers.begin();
-                active_workers.erase(active_workers.begin());
+                int worker;
+                if (pw != prepared.end()) {
+                    worker = pw->second;
+                    prepared.erase(pw);
+                } else {
+                    worker = chooseWorker(task_id);
+                    active_workers.erase(active_workers.find(worker));
+                }
                 MPI_Send(&task_id, 1, MPI_INT, worker, START_TASK_TAG, this->comm);
+                if (useLocality) {
+                    int node = this->workerNodes.at(worker);
+                    taskNode[task_id] = node;
+                    nodeBegs[node].insert(this->timeRanges.at(task_id)[0]);
+                    nodeEnds[node].insert(this->timeRanges.at(task_id)[1]);
+                    updateNodeRange(node);
+                }
+                lastEventTime[task_id] = MPI_Wtime();
+                nextStep[task_id] = this->stepBegMap.at(task_id);
+                if (useSpeculation || useMigration) taskRunners[task_id] = {worker};
+                SEAPODYM_TRACE_EVENT(TRACE_DISPATCH, task_id, -1, worker, 0);
                 assigned.insert(task_id);
+                ++numDispatched;
                 it = task_queue.erase(it);
             } else {
                 ++it;
             }
         }
+        SEAPODYM_TRACE_EVENT(TRACE_QUEUE_DEPTH, -1, -1, -1, task_queue.size());
+
+        // --- Let the workers left without ready work initialize the next tasks ---
+        if (useEarlyInit) {
+            for (auto it = task_queue.begin();
+                 it != task_queue.end() && !active_workers.empty(); ++it) {
+                int task_id = *it;
+                if (prepared.count(task_id) > 0) continue;
+                const auto& task_deps = this->deps.at(task_id);
+                bool running = std::all_of(task_deps.begin(), task_deps.end(),
+                    [&](const dep_type& d) { return completed.count(d) > 0 || assigned.count(d[0]) > 0; });
+                if (!running) continue;
+                int worker = chooseWorker(task_id);
+                active_workers.erase(active_workers.find(worker));
+                MPI_Send(&task_id, 1, MPI_INT, worker, PREPARE_TASK_TAG, this->comm);
+                SEAPODYM_TRACE_EVENT(TRACE_DISPATCH, task_id, -1, worker, 1);
+                prepared[task_id] = worker;
+            }
+        }
+
+        // --- Duplicate the straggling tasks on the workers left without ready work ---
+        bool canSpeculate = false;
+        if (useSpeculation && !active_workers.empty()) {
+            double now = MPI_Wtime();
+            for (int task_id : assigned) {
+                if (active_workers.empty()) break;
+                if (speculated.count(task_id) > 0 || migrationTargets.count(task_id) > 0) continue;
+                int step = nextStep.at(task_id);
+                double expected;
+                if (this->expectedProfile.size() > 0) {
+                    expected = this->expectedProfile.getCost(task_id, step);
+                } else if (numStepCosts > 0) {
+                    expected = stepCostSum / numStepCosts;
+                } else {
+                    continue;
+                }
+                canSpeculate = true;
+                if (now - lastEventTime.at(task_id) <= this->speculationSlowdown * expected) continue;
+                int worker = *active_workers.begin();
+                active_workers.erase(active_workers.begin());
+                std::array<int, 2> resume = {task_id, step};
+                MPI_Send(resume.data(), 2, MPI_INT, worker, RESUME_TASK_TAG, this->comm);
+                std::cout << "[Manager] duplicating task " << task_id << " from step " << step
+                          << " on worker " << worker << "\n";
+                SEAPODYM_TRACE_EVENT(TRACE_DISPATCH, task_id, step, worker, 0);
+                taskRunners[task_id].push_back(worker);
+                speculated.insert(task_id);
+                ++this->numSpeculated;
+                ++numDispatched;
+            }
+            canSpeculate = canSpeculate && !active_workers.empty();
+        }
+
+        // --- Move the tasks of slow workers to the faster workers left without ready work ---
+        if (useMigration && !active_workers.empty()) {
+            for (int task_id : assigned) {
+                if (active_workers.empty()) break;
+                if (speculated.count(task_id) > 0 || migrationTargets.count(task_id) > 0) continue;
+                int runner = taskRunners.at(task_id).front();
+                if (workerCosts.count(runner) == 0) continue;
+                if (this->stepEndMap.at(task_id) - nextStep.at(task_id) < 2) continue;
+                // fastest free worker with measured costs
+                int target = -1;
+                for (auto it = active_workers.begin(); it != active_workers.end();
+                     it = active_workers.upper_bound(*it)) {
+                    if (workerCosts.count(*it) == 0) continue;
+                    if (target < 0 || slowness(*it) < slowness(target)) target = *it;
+                }
+                if (target < 0 || slowness(runner) <= this->migrationFactor * slowness(target)) continue;
+                MPI_Send(&task_id, 1, MPI_INT, runner, CANCEL_TASK_TAG, this->comm);
+                std::cout << "[Manager] migrating task " << task_id << " from worker " << runner
+                          << " to worker " << target << "\n";
+                active_workers.erase(active_workers.find(target));
+                migrationTargets[task_id] = target;
+                migrationSources[runner] = task_id;
+            }
+        }
 
         // --- Block until the next message if there is nothing else to do ---
         // This eliminates the hot-spin when all workers are busy and no
-        // messages have arrived yet.  assigned.empty() is impossible here
-        // (the outer while would have exited), so a blocking probe is safe.
-        if (!received_any && !assigned.empty()) {
-            MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &status);
+        // messages have arrived yet. A blocking probe is only safe if tasks are
+        // assigned (they will send messages).
+        if (!received_any && (!assigned.empty() || gated)) {
+            if (canSpeculate || gated) {
+                // a blocking wait could miss the time at which a task becomes a straggler,
+                // or the gate opens
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            } else if (this->publisher) {
+                // the step completions are not messages, poll both
+                while (true) {
+                    if (pollBoard()) break;
+                    if (channel) {
+                        if (pollChannel(false)) break;
+                    } else if (iprobe(status)) {
+                        processMessage(status);
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+            } else if (channel) {
+                if (this->colocated) {
+                    while (!pollChannel(false)) std::this_thread::yield();
+                } else {
+                    pollChannel(true);
+                }
+            } else {
+                if (this->colocated) {
+                    // MPI_Probe could hold a lock inside MPI and starve the worker thread
+                    while (!iprobe(status)) std::this_thread::yield();
+                } else {
+                    MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &status);
+                }
+                processMessage(status);
+            }
+        }
+    }
+
+    // Consume the WORKER_AVAILABLE_TAG messages still in flight so that they
+    // cannot be mistaken for messages of a subsequent run. The cancelled copies of
+    // speculated tasks may also still send END_TASK_TAG messages, which are ignored
+    while (numReleased < numDispatched) {
+        if (channel) {
+            pollChannel(true);
+        } else if (useSpeculation || useMigration) {
+            if (this->colocated) {
+                while (!iprobe(status)) std::this_thread::yield();
+            } else {
+                MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, this->comm, &status);
+            }
             processMessage(status);
+        } else {
+            int dummy;
+            MPI_Recv(&dummy, 1, MPI_INT, MPI_ANY_SOURCE, WORKER_AVAILABLE_TAG,
+                     this->comm, MPI_STATUS_IGNORE);
+            ++numReleased;
         }
     }
+    if (channel) channel->free();
 
     // Shutdown all workers
     const int stop = 0;
-    for (int worker = 1; worker < size; ++worker) {
+    for (int worker = firstWorker; worker < size; worker += this->teamSize) {
         std::cout << "[Manager] shutting down worker " << worker << "\n";
         MPI_Send(&stop, 1, MPI_INT, worker, SHUTDOWN_TAG, this->comm);
     }
@@ -2,6 +2,11 @@
 #include <map>
 #include <set>
 #include <array>
+#include <vector>
+#include <functional>
+#include "TaskStepProfile.h"
+
+class TaskStepPublisher;
 
 #ifndef TASK_DEPENDENCY_MANAGER
 #define TASK_DEPENDENCY_MANAGER
@@ -48,6 +53,69 @@ class TaskStepManager {
         // dependencies
         std::map<int, std::set<dep_type> > deps;
 
+        // costs measured during the last run
+        TaskStepProfile measuredProfile;
+
+        // costs expected from a previous run, if any
+        TaskStepProfile expectedProfile;
+
+        // task priorities derived from expectedProfile, empty if no profile was set
+        std::map<int, double> priorities;
+
+        // mean relative deviation from expectedProfile above which the priorities are dropped
+        double driftTolerance = 0.5;
+
+        // number of ranks per team, only the team leaders talk to the manager
+        int teamSize = 1;
+
+        // number of tasks each worker can run concurrently
+        int numSlots = 1;
+
+        // whether a worker runs on the manager rank
+        bool colocated = false;
+
+        // number of persistent END_TASK_TAG receives per worker, 0 to probe instead
+        int completionDepth = 0;
+
+        // completion board, if the workers publish their steps one-sided
+        TaskStepPublisher* publisher = nullptr;
+
+        // taskId -> {first time index, last time index + 1}, for the forcing locality
+        std::map<int, std::array<int, 2> > timeRanges;
+
+        // rank -> node Id, empty if the locality is not used
+        std::vector<int> workerNodes;
+
+        // whether the node ranges drive the choice of the worker (otherwise they are only tracked)
+        bool localityAssign = true;
+
+        // node Id -> time range of the forcing held by the node
+        std::map<int, std::array<int, 2> > nodeTimeRanges;
+
+        // called with (node, first time index, last time index + 1) when the range of a node changes
+        std::function<void(int, int, int)> timeRangeListener;
+
+        // called with (task Id, step, result) when a step completes
+        std::function<void(int, int, int)> stepListener;
+
+        // whether a ready task may be dispatched, all tasks if empty
+        std::function<bool(int)> dispatchGate;
+
+        // a step running longer than this factor times its expected cost is duplicated, 0 to disable
+        double speculationSlowdown = 0;
+
+        // number of duplicates launched during the last run
+        int numSpeculated = 0;
+
+        // a task is migrated if its worker is slower than this factor times a free worker, 0 to disable
+        double migrationFactor = 0;
+
+        // number of tasks migrated during the last run
+        int numMigrated = 0;
+
+        // whether the free workers initialize the tasks whose dependencies are running
+        bool earlyInit = false;
+
     public:
 
         /**
@@ -63,11 +131,234 @@ class TaskStepManager {
             const std::map<int, int>& stepEndMap,
             const std::map<int, std::set<dep_type> >& dependencyMap);
 
+        /**
+         * Use the costs measured in a previous run to order the tasks. Ready tasks are
+         * dispatched by decreasing length of their remaining critical path rather than
+         * by increasing task Id. If the measured costs deviate from the profile by more
+         * than driftTolerance on average, the manager reverts to the default order.
+         * @param profile costs of a previous run, e.g. from getMeasuredProfile()
+         * @param driftTolerance mean relative deviation that triggers the fallback
+         */
+        void setProfile(const TaskStepProfile& profile, double driftTolerance = 0.5);
+
+        /**
+         * Dispatch the ready tasks by decreasing priority rather than by increasing task
+         * Id.
+         * Replaces the priorities of setProfile, without drift fallback.
+         * @param priorities task Id -> priority, the missing tasks have priority 0
+         */
+        void setPriorities(const std::map<int, double>& priorities) {
+            this->expectedProfile = TaskStepProfile();
+            this->priorities = priorities;
+        }
+
+        /**
+         * Get the per (task, step) costs measured by the manager during the last run. The
+         * cost of a step is the time between two consecutive END_TASK_TAG messages of the
+         * task (or between dispatch and the first END_TASK_TAG message)
+         * @return profile
+         */
+        const TaskStepProfile& getMeasuredProfile() const { return this->measuredProfile; }
+
+        /**
+         * Assign the tasks to teams of ranks rather than to individual ranks. The workers
+         * 1..size-1 are grouped into consecutive teams of teamSize ranks (the last team may
+         * be smaller) and only the first rank of each team receives tasks from the manager.
+         * @param teamSize number of ranks per team, must match TaskStepTeamWorker
+         * @note cannot be combined with setColocatedWorker
+         * @see TaskStepTeamWorker
+         */
+        void setTeamSize(int teamSize) { this->teamSize = teamSize; }
+
+        /**
+         * Set the number of tasks each worker runs concurrently. Each worker then
+         * receives up to numSlots tasks and returns a WORKER_AVAILABLE_TAG message
+         * per completed task.
+         * @param numSlots number of slots per worker, must match TaskStepThreadedWorker
+         * @see TaskStepThreadedWorker
+         */
+        void setWorkerSlots(int numSlots) { this->numSlots = numSlots; }
+
+        /**
+         * Also assign tasks to a TaskStepWorker running on the manager rank. The manager
+         * must then run on its own thread (MPI_THREAD_MULTIPLE), e.g.
+         *     std::thread managerThread([&]() { results = manager.run(); });
+         *     worker.run();
+         *     managerThread.join();
+         * and polls for messages instead of blocking in MPI_Probe.
+         * Not supported with teams, run throws std::invalid_argument: the teams are
+         * formed from rank 1 on.
+         * @param colocated true if rank 0 also runs a worker
+         */
+        void setColocatedWorker(bool colocated) { this->colocated = colocated; }
+
+        /**
+         * Receive the worker messages into persistent receives posted in advance
+         * (TaskStepCompletionChannel) rather than with MPI_Iprobe + MPI_Recv
+         * @param depth number of END_TASK_TAG receives posted per worker, 0 to probe
+         * @see TaskStepCompletionChannel
+         */
+        void setCompletionDepth(int depth) { this->completionDepth = depth; }
+
+        /**
+         * Read the step completions from the board of a TaskStepPublisher rather than
+         * from END_TASK_TAG messages. The task function then calls
+         * TaskStepPublisher::publishStep instead of sending END_TASK_TAG; the workers
+         * still send WORKER_AVAILABLE_TAG at the end of each task.
+         * @param publisher publisher (not owned), nullptr to use messages
+         * @see TaskStepPublisher
+         */
+        void setPublisher(TaskStepPublisher* publisher) { this->publisher = publisher; }
+
+        /**
+         * Dispatch the tasks preferably to the workers on the nodes that already hold the
+         * forcing time slabs of the task. A node holds the time range spanned by its
+         * running tasks (or by its last tasks if it is idle). Among the free workers,
+         * the one whose node range overlaps most with the time range of the task is chosen.
+         * @param timeRanges taskId -> {first time index, last time index + 1}, see
+         *                   SeapodymCohortDependencyAnalyzer::getTimeRangeMap
+         * @param workerNodes rank -> node Id, see getNodeIds
+         * @param assign false to only track the node ranges (and call the listener) while
+         *               dispatching to the lowest free rank, for comparison
+         */
+        void setForcingLocality(const std::map<int, std::array<int, 2> >& timeRanges,
+                                const std::vector<int>& workerNodes, bool assign = true) {
+            this->timeRanges = timeRanges;
+            this->workerNodes = workerNodes;
+            this->localityAssign = assign;
+        }
+
+        /**
+         * Set a function called when the forcing time range of a node changes, e.g. to let
+         * the node evict the time slabs that are no longer needed
+         * @param listener function taking the node Id, the first time index and the last
+         *                 time index + 1
+         */
+        void setTimeRangeListener(std::function<void(int, int, int)> listener) {
+            this->timeRangeListener = listener;
+        }
+
+        /**
+         * Set a function called when a step completes, once per step, e.g. to stream the
+         * output of the step (SeapodymOutputSink). The function runs in the manager loop
+         * and should return quickly
+         * @param listener function taking the task Id, the step and the step result
+         */
+        void setStepListener(std::function<void(int, int, int)> listener) {
+            this->stepListener = listener;
+        }
+
+        /**
+         * Set a function deciding whether a ready task may be dispatched, e.g. to bound the
+         * time steps held by SeapodymOutputSink (canDispatch). A task held back is checked
+         * again at each pass of the manager loop, which polls rather than blocks meanwhile.
+         * The gate must eventually let the tasks through, once the tasks already dispatched
+         * have completed
+         * @param gate function taking the task Id, returns false to hold the task back
+         */
+        void setDispatchGate(std::function<bool(int)> gate) {
+            this->dispatchGate = gate;
+        }
+
+        /**
+         * Get the time range held by each node, at the end of the last run or, from the
+         * listener, during the run
+         * @return node Id -> {first time index, last time index + 1}
+         */
+        const std::map<int, std::array<int, 2> >& getNodeTimeRanges() const {
+            return this->nodeTimeRanges;
+        }
+
+        /**
+         * Duplicate the straggling tasks at the end of a run. Once no ready task is left
+         * for the free workers, a task whose current step has been running for more than
+         * slowdown times its expected cost (from the profile, see setProfile, or else the
+         * mean step cost measured so far) is resumed from that step on a free worker
+         * (RESUME_TASK_TAG). The first completion of each step is accepted; when a task
+         * completes, the other copy is sent CANCEL_TASK_TAG, see TaskStepWorker::isCancelled.
+         * The task function must be able to resume from any step: since the original copy
+         * keeps running, it should save the state of every step under its own key (e.g. one
+         * DistDataCollector chunk per task and step) before signalling the step, and the
+         * duplicate reads the state of the step before the one it resumes from.
+         *
+         * Only supported with TaskStepWorker (one slot, no teams), message completions
+         * (no publisher) and no completion depth, otherwise ignored.
+         * @param slowdown factor, 0 to disable
+         */
+        void setSpeculation(double slowdown) { this->speculationSlowdown = slowdown; }
+
+        /**
+         * Get the number of duplicates launched during the last run
+         * @return number
+         */
+        int getNumSpeculated() const { return this->numSpeculated; }
+
+        /**
+         * Migrate the running tasks from slow workers to faster free workers. The speed of
+         * a worker is the ratio of its measured step costs to the mean cost of the same
+         * step index over all workers, so that uneven per-age costs are not mistaken for
+         * slow workers. Once no ready task is left for a free worker, a task whose worker
+         * is slower than factor times the free worker is sent CANCEL_TASK_TAG; when its
+         * worker becomes available the task is resumed (RESUME_TASK_TAG) on the free worker,
+         * which was reserved meanwhile, from the first uncompleted step.
+         *
+         * On cancellation the task function must save the state of the task, e.g.
+         * SeapodymCohortAbstract::getArrayFromState into a DistDataCollector, before
+         * returning; when resumed from a later step it restores it with setStateFromArray.
+         * See TaskStepWorker::isCancelled.
+         *
+         * Only supported with TaskStepWorker (one slot, no teams), probed messages (no
+         * completion channel) and no publisher, otherwise ignored.
+         * @param factor slowdown factor, 0 to disable
+         */
+        void setMigration(double factor) { this->migrationFactor = factor; }
+
+        /**
+         * Get the number of tasks migrated during the last run
+         * @return number
+         */
+        int getNumMigrated() const { return this->numMigrated; }
+
+        /**
+         * Let the free workers initialize the next tasks before their dependencies are
+         * complete. When no ready task is left for a free worker, a task whose
+         * dependencies are all running or complete is sent to it with PREPARE_TASK_TAG;
+         * the worker runs the initialization function of the task (see the TaskStepWorker
+         * constructor) and is reserved until the task is ready and started with
+         * START_TASK_TAG.
+         * @param earlyInit true to initialize ahead
+         * @note only TaskStepWorker handles PREPARE_TASK_TAG: early initialization is
+         *       ignored with several slots (TaskStepThreadedWorker, setNumSlots) or teams
+         *       (TaskStepTeamWorker, setTeamSize)
+         */
+        void setEarlyInit(bool earlyInit) { this->earlyInit = earlyInit; }
+
+        /**
+         * Get the node of each rank, collective
+         * @param comm communicator
+         * @return rank -> node Id (the lowest rank on the node)
+         */
+        static std::vector<int> getNodeIds(MPI_Comm comm);
+
+        /**
+         * Choose the free worker whose node holds the largest part of a time range, the
+         * forcing locality rule of run
+         * @param range {first time index, last time index + 1} of the task
+         * @param freeWorkers free workers, not empty
+         * @param workerNodes rank -> node Id
+         * @param nodeTimeRanges node Id -> time range held by the node
+         * @return the worker, the lowest free rank if no node overlaps the range
+         */
+        static int chooseLocalWorker(const std::array<int, 2>& range,
+                                     const std::multiset<int>& freeWorkers,
+                                     const std::vector<int>& workerNodes,
+                                     const std::map<int, std::array<int, 2> >& nodeTimeRanges);
+
         /**
          * Run the manager
          * @return (taskId, step, result) tuples for each task
          */
-        std::set< std::array<int, 3> > run() const;
+        std::set< std::array<int, 3> > run();
 
 };
 
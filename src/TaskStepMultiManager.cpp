@@ -0,0 +1,79 @@
+#include "TaskStepMultiManager.h"
+#include <stdexcept>
+#include <string>
+
+void
+TaskStepMultiManager::mergeJobs(const std::vector< std::map<int, int> >& stepBegMaps,
+    const std::vector< std::map<int, int> >& stepEndMaps,
+    const std::vector< std::map<int, std::set<dep_type> > >* dependencyMaps,
+    std::map<int, int>& stepBegMap,
+    std::map<int, int>& stepEndMap,
+    std::map<int, std::set<dep_type> >* dependencyMap) {
+
+    if (stepBegMaps.size() > (std::size_t) MAX_JOBS) {
+        throw std::invalid_argument(std::to_string(stepBegMaps.size()) + " jobs, more than MAX_JOBS = " +
+            std::to_string(MAX_JOBS));
+    }
+    stepBegMap.clear();
+    stepEndMap.clear();
+    if (dependencyMap) dependencyMap->clear();
+    for (std::size_t job = 0; job < stepBegMaps.size(); ++job) {
+        for (const auto& [task_id, beg] : stepBegMaps[job]) {
+            if (task_id < 0 || task_id >= MAX_JOB_TASKS) {
+                throw std::invalid_argument("task Id " + std::to_string(task_id) + " of job " +
+                    std::to_string(job) + " is outside [0, MAX_JOB_TASKS)");
+            }
+            int id = getTaskId((int) job, task_id);
+            stepBegMap[id] = beg;
+            stepEndMap[id] = stepEndMaps[job].at(task_id);
+            if (dependencyMap) {
+                auto& deps = (*dependencyMap)[id];
+                for (const auto& [dep_id, step] : (*dependencyMaps)[job].at(task_id)) {
+                    deps.insert({getTaskId((int) job, dep_id), step});
+                }
+            }
+        }
+    }
+}
+
+TaskStepMultiManager::TaskStepMultiManager(MPI_Comm comm) {
+    this->comm = comm;
+}
+
+int
+TaskStepMultiManager::addJob(const std::map<int, int>& stepBegMap,
+    const std::map<int, int>& stepEndMap,
+    const std::map<int, std::set<dep_type> >& dependencyMap) {
+    if (this->jobs.size() >= (std::size_t) MAX_JOBS) {
+        throw std::invalid_argument("TaskStepMultiManager: more than MAX_JOBS = " + std::to_string(MAX_JOBS) + " jobs");
+    }
+    this->jobs.push_back(Job{stepBegMap, stepEndMap, dependencyMap});
+    return (int) this->jobs.size() - 1;
+}
+
+std::map<int, std::set< std::array<int, 3> > >
+TaskStepMultiManager::run() const {
+
+    std::vector< std::map<int, int> > stepBegMaps, stepEndMaps;
+    std::vector< std::map<int, std::set<dep_type> > > dependencyMaps;
+    for (const Job& job : this->jobs) {
+        stepBegMaps.push_back(job.stepBegMap);
+        stepEndMaps.push_back(job.stepEndMap);
+        dependencyMaps.push_back(job.deps);
+    }
+    std::map<int, int> stepBegMap, stepEndMap;
+    std::map<int, std::set<dep_type> > dependencyMap;
+    mergeJobs(stepBegMaps, stepEndMaps, &dependencyMaps, stepBegMap, stepEndMap, &dependencyMap);
+
+    TaskStepManager manager(this->comm, (int) stepBegMap.size(), stepBegMap, stepEndMap, dependencyMap);
+
+    // split the results by job
+    std::map<int, std::set< std::array<int, 3> > > results;
+    for (int job = 0; job < (int) this->jobs.size(); ++job) results[job];
+    for (const auto& [id, step, result] : manager.run()) {
+        int job = getJobId(id);
+        results[job].insert({id - getTaskId(job, 0), step, result});
+    }
+
+    return results;
+}
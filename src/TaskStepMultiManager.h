@@ -0,0 +1,123 @@
+#include <mpi.h>
+#include <map>
+#include <set>
+#include <array>
+#include <vector>
+#include <limits>
+#include "TaskStepManager.h"
+
+#ifndef TASK_STEP_MULTI_MANAGER
+#define TASK_STEP_MULTI_MANAGER
+
+/**
+ * Class TaskStepMultiManager
+ * @brief Schedules the tasks of several independent jobs, each with its own (task, step)
+ *        dependency graph, onto a shared pool of TaskStepMultiWorkers.
+ *
+ * @details Use this to run many independent forward runs (sensitivity analysis, ensembles,
+ *          Hessian columns) in one MPI job. The jobs are merged into a single graph run by a
+ *          TaskStepManager, in which task taskId of job jobId has the Id
+ *          getTaskId(jobId, taskId). Since the ready tasks are dispatched by increasing task
+ *          Id, the ready tasks of the first jobs are dispatched first, and the tail of one
+ *          job, when there are few ready tasks, is filled with the head of the next job.
+ *
+ *          The messages are those of TaskStepManager; the job Id travels inside the task Id,
+ *          not as a separate field of the START_TASK_TAG and END_TASK_TAG messages. In
+ *          particular, the task function notifies the end of a step with END_TASK_TAG:
+ *          {getTaskId(jobId, taskId), step, result}. At most MAX_JOBS jobs fit in an int
+ *          task Id.
+ *
+ * @see TaskStepMultiWorker
+ * @see TaskStepManager
+ */
+class TaskStepMultiManager {
+
+    private:
+
+        // dependency graph of a job
+        struct Job {
+            std::map<int, int> stepBegMap;
+            std::map<int, int> stepEndMap;
+            std::map<int, std::set<dep_type> > deps;
+        };
+
+        // Communicator
+        MPI_Comm comm;
+
+        // jobs, the index is the job Id
+        std::vector<Job> jobs;
+
+    public:
+
+        // the task Ids of a job must be in [0, MAX_JOB_TASKS)
+        static constexpr int MAX_JOB_TASKS = 1 << 16;
+
+        // maximum number of jobs, so that getTaskId does not overflow
+        static constexpr int MAX_JOBS = std::numeric_limits<int>::max() / MAX_JOB_TASKS;
+
+        /**
+         * Get the Id of the task of a job in the merged graph
+         * @param jobId job Id
+         * @param taskId task Id in the job
+         * @return task Id in the merged graph
+         */
+        static int getTaskId(int jobId, int taskId) { return jobId * MAX_JOB_TASKS + taskId; }
+
+        /**
+         * Get the job of a task of the merged graph
+         * @param id task Id in the merged graph
+         * @return job Id
+         */
+        static int getJobId(int id) { return id / MAX_JOB_TASKS; }
+
+        /**
+         * Merge the graphs of several jobs
+         * @param stepBegMaps per job, map of task Id to first step index
+         * @param stepEndMaps per job, map of task Id to last step index + 1
+         * @param dependencyMaps per job, map of task dependencies (if not null)
+         * @param stepBegMap set to the merged map of task Id to first step index
+         * @param stepEndMap set to the merged map of task Id to last step index + 1
+         * @param dependencyMap set to the merged dependencies (if not null)
+         * @throw std::invalid_argument if a task Id is outside [0, MAX_JOB_TASKS) or if
+         *        there are more than MAX_JOBS jobs
+         */
+        static void mergeJobs(const std::vector< std::map<int, int> >& stepBegMaps,
+            const std::vector< std::map<int, int> >& stepEndMaps,
+            const std::vector< std::map<int, std::set<dep_type> > >* dependencyMaps,
+            std::map<int, int>& stepBegMap,
+            std::map<int, int>& stepEndMap,
+            std::map<int, std::set<dep_type> >* dependencyMap);
+
+        /**
+         * Constructor
+         * @param comm MPI communicator
+         */
+        TaskStepMultiManager(MPI_Comm comm);
+
+        /**
+         * Add a job
+         * @param stepBegMap map of task Id to first step index
+         * @param stepEndMap map of task Id to last step index + 1
+         * @param dependencyMap map of task dependencies {taskId: {taskId, step}, ...}
+         * @return job Id, 0, 1, ... in the order the jobs are added
+         * @throw std::invalid_argument if there are already MAX_JOBS jobs
+         */
+        int addJob(const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap,
+            const std::map<int, std::set<dep_type> >& dependencyMap);
+
+        /**
+         * Get the number of jobs
+         * @return number
+         */
+        int getNumJobs() const { return (int) this->jobs.size(); }
+
+        /**
+         * Run the manager
+         * @return jobId -> (taskId, step, result) tuples map
+         */
+        std::map<int, std::set< std::array<int, 3> > > run() const;
+
+};
+
+#endif // TASK_STEP_MULTI_MANAGER
@@ -0,0 +1,34 @@
+#include "TaskStepMultiWorker.h"
+#include "TaskStepMultiManager.h"
+#include "TaskStepWorker.h"
+
+TaskStepMultiWorker::TaskStepMultiWorker(MPI_Comm comm,
+  std::function<void(int, int, int, int, MPI_Comm)> taskFunc) {
+    this->comm = comm;
+    this->taskFunc = taskFunc;
+    MPI_Comm_rank(comm, &this->rank);
+}
+
+int
+TaskStepMultiWorker::addJob(const std::map<int, int>& stepBegMap,
+    const std::map<int, int>& stepEndMap) {
+    this->stepBegMaps.push_back(stepBegMap);
+    this->stepEndMaps.push_back(stepEndMap);
+    return (int) this->stepBegMaps.size() - 1;
+}
+
+void
+TaskStepMultiWorker::run() const {
+
+    std::map<int, int> stepBegMap, stepEndMap;
+    TaskStepMultiManager::mergeJobs(this->stepBegMaps, this->stepEndMaps, nullptr,
+                                    stepBegMap, stepEndMap, nullptr);
+
+    // the tasks of the merged graph are run as tasks of their job
+    auto func = [this](int id, int stepBeg, int stepEnd, MPI_Comm comm) {
+        int job = TaskStepMultiManager::getJobId(id);
+        this->taskFunc(job, id - TaskStepMultiManager::getTaskId(job, 0), stepBeg, stepEnd, comm);
+    };
+    TaskStepWorker worker(this->comm, func, stepBegMap, stepEndMap);
+    worker.run();
+}
@@ -0,0 +1,67 @@
+#include <mpi.h>
+#include <functional>
+#include <map>
+#include <vector>
+
+#ifndef TASK_STEP_MULTI_WORKER
+#define TASK_STEP_MULTI_WORKER
+
+/**
+ * Class TaskStepMultiWorker
+ * @brief Executes the tasks of several jobs assigned by the TaskStepMultiManager.
+ *
+ * @details The jobs must be added in the same order as on the manager, so that the
+ *          job Ids match. The tasks of the merged graph are run by a TaskStepWorker.
+ *
+ * @see TaskStepMultiManager
+ */
+class TaskStepMultiWorker {
+
+    private:
+
+        // communicator
+        MPI_Comm comm;
+
+        // task function, takes jobId, task_id, stepBeg, stepEnd and the communicator
+        std::function<void(int, int, int, int, MPI_Comm)> taskFunc;
+
+        // per job, task Id to first step index map
+        std::vector< std::map<int, int> > stepBegMaps;
+
+        // per job, task Id to last step index + 1 map
+        std::vector< std::map<int, int> > stepEndMaps;
+
+        // local rank
+        int rank;
+
+    public:
+
+        /**
+         * Constructor
+         * @param comm MPI communicator
+         * @param taskFunc task function takes jobId, task_id, stepBeg, stepEnd and the MPI
+         *                 communicator as input arguments. This function should notify the
+         *                 manager at the end of each step, ie
+         *                 MPI_Send({TaskStepMultiManager::getTaskId(jobId, task_id), step, result}, 3,
+         *                          MPI_INT, managerRank, END_TASK_TAG, comm);
+         */
+        TaskStepMultiWorker(MPI_Comm comm,
+            std::function<void(int, int, int, int, MPI_Comm)> taskFunc);
+
+        /**
+         * Add a job
+         * @param stepBegMap map of task Id to first step index
+         * @param stepEndMap map of task Id to last step index + 1
+         * @return job Id
+         */
+        int addJob(const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap);
+
+        /**
+         * Run the tasks assigned by the TaskStepMultiManager
+         */
+        void run() const;
+
+};
+
+#endif // TASK_STEP_MULTI_WORKER
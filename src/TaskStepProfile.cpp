@@ -0,0 +1,121 @@
+#include "TaskStepProfile.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+void
+TaskStepProfile::setCost(int taskId, int step, double seconds) {
+    auto it = this->costs.find({taskId, step});
+    if (it != this->costs.end()) {
+        // replace the previous measurement
+        this->stepSums[step][0] -= it->second;
+        this->stepSums[step][1] -= 1;
+        this->totalCost -= it->second;
+    }
+    this->costs[{taskId, step}] = seconds;
+    this->stepSums[step][0] += seconds;
+    this->stepSums[step][1] += 1;
+    this->totalCost += seconds;
+}
+
+double
+TaskStepProfile::getCost(int taskId, int step) const {
+    auto it = this->costs.find({taskId, step});
+    if (it != this->costs.end()) return it->second;
+    auto its = this->stepSums.find(step);
+    if (its != this->stepSums.end() && its->second[1] > 0) {
+        return its->second[0] / its->second[1];
+    }
+    if (!this->costs.empty()) return this->totalCost / double(this->costs.size());
+    return 1.0;
+}
+
+std::map<int, double>
+TaskStepProfile::getPriorities(const std::map<int, int>& stepBegMap,
+    const std::map<int, int>& stepEndMap,
+    const std::map<int, std::set<std::array<int, 2>>>& dependencyMap) const {
+
+    // (task, step) -> tasks that can only start after this step
+    std::map<std::array<int, 2>, std::vector<int>> dependents;
+    // number of distinct tasks that depend on each task, for the reverse topological order
+    std::map<int, std::set<int>> dependentTasks;
+    std::map<int, int> outDegree;
+    for (const auto& [task_id, beg] : stepBegMap) {
+        outDegree[task_id];
+        for (const auto& d : dependencyMap.at(task_id)) {
+            dependents[d].push_back(task_id);
+            if (dependentTasks[d[0]].insert(task_id).second) outDegree[d[0]]++;
+        }
+    }
+
+    std::vector<int> stack;
+    for (const auto& [task_id, n] : outDegree) {
+        if (n == 0) stack.push_back(task_id);
+    }
+
+    std::map<int, double> priority;
+    while (!stack.empty()) {
+        int task_id = stack.back();
+        stack.pop_back();
+
+        // walk the steps backwards: the longest path from (task, step) to the end is
+        // the cost of the step plus the longest of the next step's path and the paths
+        // of the tasks unlocked by this step
+        double level = 0;
+        for (int step = stepEndMap.at(task_id) - 1; step >= stepBegMap.at(task_id); --step) {
+            double next = level;
+            auto it = dependents.find({task_id, step});
+            if (it != dependents.end()) {
+                for (int other : it->second) next = std::max(next, priority.at(other));
+            }
+            level = this->getCost(task_id, step) + next;
+        }
+        priority[task_id] = level;
+
+        for (const auto& d : dependencyMap.at(task_id)) {
+            // a task appears once per dependency step, only count it once
+            if (dependentTasks[d[0]].erase(task_id) && --outDegree[d[0]] == 0) {
+                stack.push_back(d[0]);
+            }
+        }
+    }
+    return priority;
+}
+
+bool
+TaskStepProfile::save(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Error: unable to write profile " << filename << '\n';
+        return false;
+    }
+    out << "taskId,step,seconds\n" << std::setprecision(9);
+    for (const auto& [key, seconds] : this->costs) {
+        out << key[0] << ',' << key[1] << ',' << seconds << '\n';
+    }
+    return true;
+}
+
+bool
+TaskStepProfile::load(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Error: unable to read profile " << filename << '\n';
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        int task_id, step;
+        double seconds;
+        char comma1, comma2;
+        // the header line fails to parse and is skipped
+        if (ss >> task_id >> comma1 >> step >> comma2 >> seconds) {
+            this->setCost(task_id, step, seconds);
+        }
+    }
+    return true;
+}
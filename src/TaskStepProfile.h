@@ -0,0 +1,88 @@
+#include <map>
+#include <set>
+#include <array>
+#include <string>
+
+#ifndef TASK_STEP_PROFILE
+#define TASK_STEP_PROFILE
+
+/**
+ * Class TaskStepProfile
+ * @brief Measured execution cost of each (task, step)
+ *
+ * @details A profile is recorded by TaskStepManager during one run and can be fed back
+ *          into the next run of the same dependency graph, e.g. the next iteration of a
+ *          parameter estimation. For cohorts, the step index is the age, so a missing
+ *          (task, step) entry falls back to the mean cost of that step across tasks.
+ *
+ *          The profile is stored as CSV lines taskId,step,seconds, which is also the trace
+ *          format read by testTaskStepSimulator.
+ */
+class TaskStepProfile {
+
+    private:
+
+        // (taskId, step) -> seconds
+        std::map<std::array<int, 2>, double> costs;
+
+        // step -> (sum of seconds, count), for the fallback
+        std::map<int, std::array<double, 2>> stepSums;
+
+        // sum of all the costs
+        double totalCost = 0;
+
+    public:
+
+        /**
+         * Set the cost of a step
+         * @param taskId task Id
+         * @param step step index
+         * @param seconds execution time
+         */
+        void setCost(int taskId, int step, double seconds);
+
+        /**
+         * Get the cost of a step. Falls back to the mean cost of the step across tasks,
+         * then to the mean cost of all steps, then to 1
+         * @param taskId task Id
+         * @param step step index
+         * @return seconds
+         */
+        double getCost(int taskId, int step) const;
+
+        /**
+         * Get the number of recorded (task, step) costs
+         * @return number
+         */
+        std::size_t size() const { return this->costs.size(); }
+
+        /**
+         * Compute the scheduling priority of each task, the cost of the longest path
+         * from the start of the task to the end of the graph (its "bottom level").
+         * Tasks on the critical path have the highest priority.
+         * @param stepBegMap taskId -> first step map
+         * @param stepEndMap taskId -> last step + 1 map
+         * @param dependencyMap map of task dependencies {taskId: {taskId, step}, ...}
+         * @return taskId -> priority map
+         */
+        std::map<int, double> getPriorities(const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap,
+            const std::map<int, std::set<std::array<int, 2>>>& dependencyMap) const;
+
+        /**
+         * Write the profile in CSV format
+         * @param filename file name
+         * @return true if successful
+         */
+        bool save(const std::string& filename) const;
+
+        /**
+         * Read a profile written by save
+         * @param filename file name
+         * @return true if successful
+         */
+        bool load(const std::string& filename);
+
+};
+
+#endif // TASK_STEP_PROFILE
@@ -0,0 +1,66 @@
+#include "TaskStepPublisher.h"
+#include <algorithm>
+
+TaskStepPublisher::TaskStepPublisher(MPI_Comm comm,
+    const std::map<int, int>& stepBegMap,
+    const std::map<int, int>& stepEndMap,
+    int rootRank) {
+
+    this->comm = comm;
+    this->rootRank = rootRank;
+    this->stepBegMap = stepBegMap;
+    MPI_Comm_rank(comm, &this->rank);
+
+    this->numSlots = 0;
+    for (const auto& [task_id, beg] : stepBegMap) {
+        this->offsets[task_id] = this->numSlots;
+        this->numSlots += stepEndMap.at(task_id) - beg;
+    }
+
+    MPI_Aint winSize = (this->rank == rootRank) ? this->numSlots * sizeof(int) : 0;
+    MPI_Win_allocate(winSize, sizeof(int), MPI_INFO_NULL, comm, &this->board, &this->win);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, this->win);
+    if (this->rank == rootRank) this->reset();
+
+    // the board must be cleared before any step is published
+    MPI_Barrier(comm);
+}
+
+void
+TaskStepPublisher::publishStep(DistDataCollector& collector, int chunkId, const double* data,
+                               int taskId, int step, int result) {
+    {
+        std::lock_guard<std::mutex> guard(this->collectorsMutex);
+        if (!this->collectors.count(&collector) && !collector.isInEpoch()) {
+            collector.startEpoch();
+            this->collectors.insert(&collector);
+        }
+    }
+    // within the epoch, put and flush the data without lock/unlock, so that they are
+    // complete at the root when the flag becomes visible
+    collector.put(chunkId, data);
+    this->publishStep(taskId, step, result);
+}
+
+void
+TaskStepPublisher::publishStep(int taskId, int step, int result) {
+    MPI_Aint slot = this->offsets.at(taskId) + step - this->stepBegMap.at(taskId);
+    MPI_Accumulate(&result, 1, MPI_INT, this->rootRank, slot, 1, MPI_INT, MPI_REPLACE, this->win);
+    MPI_Win_flush(this->rootRank, this->win);
+}
+
+void
+TaskStepPublisher::reset() {
+    std::fill(this->board, this->board + this->numSlots, EMPTY);
+    MPI_Win_sync(this->win);
+}
+
+void
+TaskStepPublisher::free() {
+    for (DistDataCollector* collector : this->collectors) collector->endEpoch();
+    this->collectors.clear();
+    if (this->win != MPI_WIN_NULL) {
+        MPI_Win_unlock_all(this->win);
+        MPI_Win_free(&this->win);
+    }
+}
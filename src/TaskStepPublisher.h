@@ -0,0 +1,147 @@
+#include <mpi.h>
+#include <map>
+#include <set>
+#include <mutex>
+#include <limits>
+#include "DistDataCollector.h"
+
+#ifndef TASK_STEP_PUBLISHER
+#define TASK_STEP_PUBLISHER
+
+/**
+ * Class TaskStepPublisher
+ * @brief One-sided notification of step completions through a completion board, an
+ *        RMA window of one int per (task, step) on the manager rank.
+ *
+ * @details Rather than putting the step data and then sending an END_TASK_TAG message,
+ *          a worker calls publishStep, which puts the data and then writes the step result
+ *          into the board slot of (task, step) with MPI_Accumulate(MPI_REPLACE). The manager
+ *          (TaskStepManager::setPublisher) polls the board instead of receiving messages.
+ *
+ *          The board window stays in a passive target epoch (MPI_Win_lock_all) from
+ *          construction to free, and so does the epoch of each collector from its first
+ *          publishStep (DistDataCollector::startEpoch) to free: no lock/unlock is paid per
+ *          step, the put and the flag update are issued back to back.
+ *
+ *          A step still costs two flushes, not one: the data and the board are different
+ *          windows and MPI does not order RMA operations, so the data window is flushed
+ *          before the flag is written, otherwise the manager could see the flag before the
+ *          data. The board is then flushed so that the flag is visible without waiting for
+ *          the next step.
+ *
+ * @see TaskStepManager::setPublisher
+ */
+class TaskStepPublisher {
+
+    private:
+
+        // communicator
+        MPI_Comm comm;
+
+        // rank holding the board
+        int rootRank;
+
+        // local rank
+        int rank;
+
+        // board slot of the first step of each task
+        std::map<int, int> offsets;
+
+        // first step of each task
+        std::map<int, int> stepBegMap;
+
+        // total number of (task, step) slots
+        int numSlots;
+
+        // board, numSlots ints on rootRank
+        int* board;
+
+        // board window
+        MPI_Win win;
+
+        // collectors whose epoch was started by publishStep, ended by free
+        std::set<DistDataCollector*> collectors;
+
+        // guards collectors, publishStep may be called by several threads
+        std::mutex collectorsMutex;
+
+    public:
+
+        // value of the slots of the steps not yet published
+        static constexpr int EMPTY = std::numeric_limits<int>::min();
+
+        /**
+         * Constructor, collective
+         * @param comm MPI communicator
+         * @param stepBegMap map of task Id to first step index
+         * @param stepEndMap map of task Id to last step index + 1
+         * @param rootRank rank holding the board (the manager)
+         */
+        TaskStepPublisher(MPI_Comm comm,
+            const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap,
+            int rootRank = 0);
+
+        /**
+         * Destructor
+         */
+        ~TaskStepPublisher() { this->free(); }
+
+        TaskStepPublisher(const TaskStepPublisher&) = delete;
+        TaskStepPublisher& operator=(const TaskStepPublisher&) = delete;
+
+        /**
+         * Put the data of a step and mark the step as complete, on the worker
+         * @param collector data collector, its epoch is started on the first call unless
+         *        the caller already started it, and ended by free
+         * @param chunkId chunk of the collector receiving the data
+         * @param data data to put, collector.getNumSize() values
+         * @param taskId task Id
+         * @param step step index
+         * @param result step result, any value other than EMPTY
+         */
+        void publishStep(DistDataCollector& collector, int chunkId, const double* data,
+                         int taskId, int step, int result);
+
+        /**
+         * Mark a step as complete, without data
+         * @param taskId task Id
+         * @param step step index
+         * @param result step result, any value other than EMPTY
+         */
+        void publishStep(int taskId, int step, int result);
+
+        /**
+         * Clear the board, on the root rank before the steps are executed
+         */
+        void reset();
+
+        /**
+         * Check whether a step has been published, on the root rank
+         * @param taskId task Id
+         * @param step step index
+         * @param result set to the step result if published
+         * @return true if published
+         */
+        bool isPublished(int taskId, int step, int& result) const {
+            int value = reinterpret_cast<volatile int*>(this->board)[this->offsets.at(taskId) + step - this->stepBegMap.at(taskId)];
+            if (value == EMPTY) return false;
+            result = value;
+            return true;
+        }
+
+        /**
+         * Make the latest remote updates of the board visible, on the root rank before
+         * calling isPublished
+         */
+        void sync() { MPI_Win_sync(this->win); }
+
+        /**
+         * End the epochs of the collectors and free the window, call before freeing
+         * the collectors passed to publishStep and before MPI_Finalize
+         */
+        void free();
+
+};
+
+#endif // TASK_STEP_PUBLISHER
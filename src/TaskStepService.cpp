@@ -0,0 +1,71 @@
+#include "TaskStepService.h"
+#include <algorithm>
+
+TaskStepService::TaskStepService(MPI_Comm comm, int numTasks,
+    const std::map<int, int>& stepBegMap,
+    const std::map<int, int>& stepEndMap,
+    const std::map<int, std::set<dep_type> >& dependencyMap,
+    std::function<void(int, int, int, MPI_Comm)> taskFunc) :
+    manager(comm, numTasks, stepBegMap, stepEndMap, dependencyMap),
+    worker(comm, taskFunc, stepBegMap, stepEndMap) {
+    this->comm = comm;
+    MPI_Comm_rank(comm, &this->rank);
+}
+
+double
+TaskStepService::evaluate(const std::vector<double>& params, std::vector<double>& gradient) {
+
+    // command, number of parameters, number of gradient components
+    int header[3] = {EVALUATE, (int) params.size(), (int) gradient.size()};
+    MPI_Bcast(header, 3, MPI_INT, 0, this->comm);
+    std::vector<double> p(params);
+    MPI_Bcast(p.data(), header[1], MPI_DOUBLE, 0, this->comm);
+
+    return this->runEvaluation(p, gradient);
+}
+
+void
+TaskStepService::stop() {
+    int header[3] = {STOP, 0, 0};
+    MPI_Bcast(header, 3, MPI_INT, 0, this->comm);
+}
+
+void
+TaskStepService::serve() {
+    while (true) {
+        int header[3];
+        MPI_Bcast(header, 3, MPI_INT, 0, this->comm);
+        if (header[0] == STOP) break;
+
+        std::vector<double> params(header[1]);
+        MPI_Bcast(params.data(), header[1], MPI_DOUBLE, 0, this->comm);
+        std::vector<double> gradient(header[2]);
+        this->runEvaluation(params, gradient);
+    }
+}
+
+double
+TaskStepService::runEvaluation(const std::vector<double>& params, std::vector<double>& gradient) {
+
+    if (this->paramFunc) this->paramFunc(params);
+
+    if (this->rank == 0) {
+        this->lastResults = this->manager.run();
+    } else {
+        this->worker.run();
+    }
+
+    // objective followed by the gradient components
+    std::vector<double> local(1 + gradient.size(), 0.0);
+    std::fill(gradient.begin(), gradient.end(), 0.0);
+    if (this->objectiveFunc) {
+        local[0] = this->objectiveFunc(gradient);
+        std::copy(gradient.begin(), gradient.end(), local.begin() + 1);
+    }
+    std::vector<double> global(local.size(), 0.0);
+    MPI_Reduce(local.data(), global.data(), (int) local.size(), MPI_DOUBLE, MPI_SUM, 0, this->comm);
+    std::copy(global.begin() + 1, global.end(), gradient.begin());
+
+    this->numEvaluations++;
+    return global[0];
+}
@@ -0,0 +1,159 @@
+#include <mpi.h>
+#include <functional>
+#include <map>
+#include <set>
+#include <array>
+#include <vector>
+#include "TaskStepManager.h"
+#include "TaskStepWorker.h"
+
+#ifndef TASK_STEP_SERVICE
+#define TASK_STEP_SERVICE
+
+/**
+ * Class TaskStepService
+ * @brief Keeps a TaskStepManager and its TaskStepWorkers resident across repeated model
+ *        evaluations, e.g. the iterations of a parameter estimation.
+ *
+ * @details Forcing, grid and cohort buffers are loaded once, before the service is created.
+ *          Each evaluation then costs one broadcast of the parameter values, a run of the
+ *          task farm and one reduction of the objective value and its gradient:
+ *
+ *          - rank 0 (manager) calls evaluate() for each set of parameters and stop() when done
+ *          - the other ranks (workers) call serve(), which returns after stop()
+ *
+ *          The parameter function is called on every rank before the tasks are run, so
+ *          that the task function sees the new parameter values. The objective function is
+ *          also called on every rank, including the manager which holds the DistDataCollector
+ *          data, and returns the local contribution to the objective and gradient.
+ *          ADMB dvar_vector parameters are passed as their values (std::vector<double>).
+ *
+ * @see TaskStepManager
+ * @see TaskStepWorker
+ */
+class TaskStepService {
+
+    private:
+
+        // commands broadcast by the manager at the start of each evaluation
+        static const int EVALUATE = 1;
+        static const int STOP = 0;
+
+        // communicator
+        MPI_Comm comm;
+
+        // local rank
+        int rank;
+
+        // runs on rank 0
+        TaskStepManager manager;
+
+        // runs on the other ranks
+        TaskStepWorker worker;
+
+        // called on all the ranks with the new parameter values
+        std::function<void(const std::vector<double>&)> paramFunc;
+
+        // returns the local contribution to the objective, adds to the gradient
+        std::function<double(std::vector<double>&)> objectiveFunc;
+
+        // number of completed evaluations
+        int numEvaluations = 0;
+
+        // results of the last run, manager only
+        std::set< std::array<int, 3> > lastResults;
+
+        /**
+         * Run the tasks and reduce the objective, collective
+         * @param params parameter values (same on all ranks)
+         * @param gradient gradient, resized to the number of gradient components and
+         *                 only valid on the manager on return
+         * @return objective value (manager only)
+         */
+        double runEvaluation(const std::vector<double>& params, std::vector<double>& gradient);
+
+    public:
+
+        /**
+         * Constructor, collective
+         * @param comm MPI communicator
+         * @param numTasks number of tasks
+         * @param stepBegMap map of task Id to first step index
+         * @param stepEndMap map of task Id to last step index + 1
+         * @param dependencyMap map of task dependencies {taskId: {taskId, step}, ...}
+         * @param taskFunc task function, see TaskStepWorker
+         */
+        TaskStepService(MPI_Comm comm, int numTasks,
+            const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap,
+            const std::map<int, std::set<dep_type> >& dependencyMap,
+            std::function<void(int, int, int, MPI_Comm)> taskFunc);
+
+        /**
+         * Set the function receiving the parameter values at the start of each evaluation
+         * @param f function called on all ranks
+         */
+        void setParameterFunction(std::function<void(const std::vector<double>&)> f) {
+            this->paramFunc = f;
+        }
+
+        /**
+         * Set the function returning the local contribution to the objective at the end of
+         * each evaluation. The function adds its contribution to the gradient argument,
+         * which has been zeroed
+         * @param f function called on all ranks
+         */
+        void setObjectiveFunction(std::function<double(std::vector<double>&)> f) {
+            this->objectiveFunc = f;
+        }
+
+        /**
+         * Evaluate the model for a set of parameters, manager only
+         * @param params parameter values
+         * @param gradient on input, sized to the number of gradient components (0 if no
+         *                 gradient is needed); on output the reduced gradient
+         * @return the objective value, summed over all ranks
+         */
+        double evaluate(const std::vector<double>& params, std::vector<double>& gradient);
+
+        /**
+         * Evaluate the model without gradient, manager only
+         * @param params parameter values
+         * @return the objective value, summed over all ranks
+         */
+        double evaluate(const std::vector<double>& params) {
+            std::vector<double> gradient;
+            return this->evaluate(params, gradient);
+        }
+
+        /**
+         * Release the workers, manager only
+         */
+        void stop();
+
+        /**
+         * Serve evaluations until the manager calls stop, workers only
+         */
+        void serve();
+
+        /**
+         * Get the manager, e.g. to set a profile
+         * @return manager
+         */
+        TaskStepManager& getManager() { return this->manager; }
+
+        /**
+         * Get the (taskId, step, result) tuples of the last evaluation, manager only
+         * @return results
+         */
+        const std::set< std::array<int, 3> >& getLastResults() const { return this->lastResults; }
+
+        /**
+         * Get the number of evaluations performed so far
+         * @return number
+         */
+        int getNumEvaluations() const { return this->numEvaluations; }
+
+};
+
+#endif // TASK_STEP_SERVICE
@@ -0,0 +1,173 @@
+#include "TaskStepSimulator.h"
+#include "Tags.h"
+#include <queue>
+#include <deque>
+#include <algorithm>
+
+namespace {
+
+// A message travelling from a worker to the manager
+struct SimMessage {
+    int tag;
+    int source;
+    int taskId;
+    int step;
+};
+
+// MANAGER_FREE events fire when the manager has finished processing
+enum SimEventKind { MESSAGE_ARRIVAL, MANAGER_FREE };
+
+struct SimEvent {
+    double time;
+    // insertion counter, breaks ties so that messages from the same
+    // worker arrive in the order they were sent
+    std::size_t seq;
+    SimEventKind kind;
+    SimMessage msg;
+    bool operator>(const SimEvent& other) const {
+        return time > other.time || (time == other.time && seq > other.seq);
+    }
+};
+
+} // namespace
+
+TaskStepSimulator::TaskStepSimulator(int numWorkers,
+      const std::map<int, int>& stepBegMap,
+      const std::map<int, int>& stepEndMap,
+      const std::map<int, std::set<std::array<int, 2>>>& dependencyMap) {
+
+    this->numWorkers = numWorkers;
+    this->stepBegMap = stepBegMap;
+    this->stepEndMap = stepEndMap;
+    this->deps = dependencyMap;
+    this->costFunc = [](int, int, int) { return 1.0; };
+    this->policy = [](const std::set<int>& readyTasks) { return *readyTasks.begin(); };
+}
+
+TaskStepSimulatorResult
+TaskStepSimulator::run() const {
+
+    TaskStepSimulatorResult res;
+
+    const double rmaTime = this->rmaLatency +
+        (this->rmaBandwidth > 0 ? double(this->chunkBytes) / this->rmaBandwidth : 0.0);
+
+    // number of outstanding (task, step) dependencies of each task and reverse index
+    std::map<int, std::size_t> numPending;
+    std::map<std::array<int, 2>, std::vector<int>> dependents;
+    std::set<int> ready;
+    for (const auto& [task_id, beg] : this->stepBegMap) {
+        const auto& task_deps = this->deps.at(task_id);
+        numPending[task_id] = task_deps.size();
+        for (const auto& d : task_deps) dependents[d].push_back(task_id);
+        if (task_deps.empty()) ready.insert(task_id);
+    }
+
+    std::set<int> freeWorkers;
+    for (int w = 1; w <= this->numWorkers; ++w) freeWorkers.insert(w);
+    std::vector<double> busyTime(this->numWorkers, 0.0);
+
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events;
+    std::size_t seq = 0;
+    std::deque<SimMessage> inbox;
+    bool managerBusy = false;
+    std::size_t numAssigned = 0;
+    const std::size_t numTasks = this->stepBegMap.size();
+
+    double now = 0;
+    double lastDepthChange = 0;
+    double depthIntegral = 0;
+
+    auto recordDepth = [&](double t) {
+        depthIntegral += double(inbox.size()) * (t - lastDepthChange);
+        lastDepthChange = t;
+    };
+
+    // Schedule the whole timeline of a task on a worker. The timeline only
+    // depends on the start time since the worker does not wait on anyone.
+    auto startTask = [&](int task_id, int worker, double t) {
+        double tBeg = t;
+        t += double(this->deps.at(task_id).size()) * rmaTime + this->initCost;
+        int stepEnd = this->stepEndMap.at(task_id);
+        for (int step = this->stepBegMap.at(task_id); step < stepEnd; ++step) {
+            t += this->costFunc(task_id, step, worker) + rmaTime;
+            events.push({t + this->messageLatency, seq++, MESSAGE_ARRIVAL,
+                         {END_TASK_TAG, worker, task_id, step}});
+        }
+        events.push({t + this->messageLatency, seq++, MESSAGE_ARRIVAL,
+                     {WORKER_AVAILABLE_TAG, worker, task_id, -1}});
+        busyTime[worker - 1] += t - tBeg;
+    };
+
+    // The manager processes one message at a time, and once its inbox is
+    // empty it assigns all the ready tasks, as TaskStepManager::run() does
+    auto managerStep = [&](double t) {
+        if (!inbox.empty()) {
+            recordDepth(t);
+            SimMessage msg = inbox.front();
+            inbox.pop_front();
+            res.numMessages++;
+            if (msg.tag == END_TASK_TAG) {
+                res.numSteps++;
+                res.makespan = std::max(res.makespan, t);
+                auto it = dependents.find({msg.taskId, msg.step});
+                if (it != dependents.end()) {
+                    for (int other : it->second) {
+                        if (--numPending[other] == 0) ready.insert(other);
+                    }
+                }
+            } else {
+                freeWorkers.insert(msg.source);
+            }
+            managerBusy = true;
+            events.push({t + this->managerOverhead, seq++, MANAGER_FREE, {}});
+            return;
+        }
+        std::size_t numSent = 0;
+        while (!ready.empty() && !freeWorkers.empty()) {
+            int task_id = this->policy(ready);
+            ready.erase(task_id);
+            int worker = *freeWorkers.begin();
+            freeWorkers.erase(freeWorkers.begin());
+            ++numSent;
+            startTask(task_id, worker, t + numSent * this->managerOverhead + this->messageLatency);
+            ++numAssigned;
+        }
+        res.maxReadyTasks = std::max(res.maxReadyTasks, ready.size());
+        if (numSent > 0) {
+            res.numMessages += numSent;
+            managerBusy = true;
+            events.push({t + numSent * this->managerOverhead, seq++, MANAGER_FREE, {}});
+        }
+    };
+
+    managerStep(now);
+
+    while (!events.empty()) {
+        SimEvent ev = events.top();
+        events.pop();
+        now = ev.time;
+        if (ev.kind == MESSAGE_ARRIVAL) {
+            recordDepth(now);
+            inbox.push_back(ev.msg);
+            res.maxManagerQueueDepth = std::max(res.maxManagerQueueDepth, inbox.size());
+        } else {
+            managerBusy = false;
+        }
+        if (!managerBusy) managerStep(now);
+    }
+
+    res.meanManagerQueueDepth = (now > 0) ? depthIntegral / now : 0.0;
+    res.workerIdleTime.resize(this->numWorkers);
+    double idleSum = 0;
+    for (int w = 0; w < this->numWorkers; ++w) {
+        res.workerIdleTime[w] = std::max(0.0, res.makespan - busyTime[w]);
+        idleSum += res.workerIdleTime[w];
+    }
+    res.meanWorkerIdleTime = (this->numWorkers > 0) ? idleSum / this->numWorkers : 0.0;
+
+    // tasks which never became ready indicate a broken dependency graph
+    if (numAssigned < numTasks) res.makespan = -1;
+
+    return res;
+}
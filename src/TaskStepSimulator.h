@@ -0,0 +1,177 @@
+#include <map>
+#include <set>
+#include <array>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+#ifndef TASK_STEP_SIMULATOR
+#define TASK_STEP_SIMULATOR
+
+/**
+ * @brief Outcome of a TaskStepSimulator run. All times are in seconds.
+ */
+struct TaskStepSimulatorResult {
+
+    // time at which the manager processed the last step, -1 if some tasks could never be assigned
+    double makespan = 0;
+
+    // idle time of each worker (index 0 is worker rank 1)
+    std::vector<double> workerIdleTime;
+
+    // average idle time across workers
+    double meanWorkerIdleTime = 0;
+
+    // largest number of messages waiting to be processed by the manager
+    std::size_t maxManagerQueueDepth = 0;
+
+    // time-averaged number of messages waiting to be processed by the manager
+    double meanManagerQueueDepth = 0;
+
+    // largest number of ready tasks waiting for a worker
+    std::size_t maxReadyTasks = 0;
+
+    // number of messages sent/received by the manager
+    std::size_t numMessages = 0;
+
+    // number of completed steps
+    std::size_t numSteps = 0;
+};
+
+/**
+ * Class TaskStepSimulator
+ * @brief Discrete-event simulator of the TaskStepManager/TaskStepWorker protocol.
+ *
+ * @details The simulator replays the TaskStepManager scheduling loop on virtual workers:
+ *          the manager drains all pending messages (END_TASK_TAG after every step,
+ *          WORKER_AVAILABLE_TAG after every task), then assigns the ready tasks to the free
+ *          workers with the lowest rank. The manager processes one message at a time and
+ *          pays a fixed overhead per message received or sent. A worker that receives a task
+ *          fetches one chunk per dependency, initializes the task, then executes each step
+ *          followed by one chunk put and an END_TASK_TAG message.
+ *
+ *          The order in which ready tasks are picked can be replaced with setPolicy to
+ *          evaluate new scheduling policies without running the MPI code.
+ *
+ * @see TaskStepManager
+ */
+class TaskStepSimulator {
+
+    public:
+
+        /**
+         * Cost in seconds of executing a step
+         * @param taskId task Id
+         * @param step step index
+         * @param worker worker rank
+         */
+        using CostFunction = std::function<double(int taskId, int step, int worker)>;
+
+        /**
+         * Select the next task to assign among the ready tasks
+         * @param readyTasks Ids of the tasks whose dependencies are satisfied, in ascending order
+         * @return Id of the task to assign, must be an element of readyTasks
+         */
+        using Policy = std::function<int(const std::set<int>& readyTasks)>;
+
+    private:
+
+        // number of virtual workers
+        int numWorkers;
+
+        // taskId to first step index map
+        std::map<int, int> stepBegMap;
+
+        // taskId to last step index + 1 map
+        std::map<int, int> stepEndMap;
+
+        // dependencies
+        std::map<int, std::set<std::array<int, 2>>> deps;
+
+        // step cost
+        CostFunction costFunc;
+
+        // scheduling policy
+        Policy policy;
+
+        // time to initialize a task after its dependencies have been fetched
+        double initCost = 0;
+
+        // point-to-point message latency
+        double messageLatency = 0;
+
+        // manager time spent per message received or sent
+        double managerOverhead = 0;
+
+        // RMA latency per put/get
+        double rmaLatency = 0;
+
+        // RMA bandwidth in bytes/second (0 means infinite)
+        double rmaBandwidth = 0;
+
+        // bytes transferred per put/get
+        std::size_t chunkBytes = 0;
+
+    public:
+
+        /**
+         * Constructor
+         * @param numWorkers number of virtual workers (ranks 1...numWorkers)
+         * @param stepBegMap taskId -> first step map
+         * @param stepEndMap taskId -> last step + 1 map
+         * @param dependencyMap map of task dependencies {taskId: {taskId, step}, ...}
+         */
+        TaskStepSimulator(int numWorkers,
+            const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap,
+            const std::map<int, std::set<std::array<int, 2>>>& dependencyMap);
+
+        /**
+         * Set the cost of each step (default: 1 second)
+         * @param costFunc function of (taskId, step, worker) returning seconds
+         */
+        void setCostFunction(CostFunction costFunc) { this->costFunc = costFunc; }
+
+        /**
+         * Set the scheduling policy (default: lowest ready task Id first, as in TaskStepManager)
+         * @param policy function selecting the next task among the ready tasks
+         */
+        void setPolicy(Policy policy) { this->policy = policy; }
+
+        /**
+         * Set the time to initialize a task
+         * @param seconds
+         */
+        void setInitCost(double seconds) { this->initCost = seconds; }
+
+        /**
+         * Set the message passing parameters
+         * @param latency point-to-point message latency in seconds
+         * @param managerOverhead time the manager spends receiving or sending one message in seconds
+         */
+        void setMessageParameters(double latency, double managerOverhead) {
+            this->messageLatency = latency;
+            this->managerOverhead = managerOverhead;
+        }
+
+        /**
+         * Set the RMA parameters of the DistDataCollector traffic
+         * @param latency time of a lock/put/flush/unlock or lock/get/flush/unlock sequence in seconds
+         * @param bandwidth bytes per second, 0 for infinite
+         * @param chunkBytes number of bytes of each chunk
+         */
+        void setRmaParameters(double latency, double bandwidth, std::size_t chunkBytes) {
+            this->rmaLatency = latency;
+            this->rmaBandwidth = bandwidth;
+            this->chunkBytes = chunkBytes;
+        }
+
+        /**
+         * Run the simulation
+         * @return makespan, idle times and queue depths
+         */
+        TaskStepSimulatorResult run() const;
+
+};
+
+#endif // TASK_STEP_SIMULATOR
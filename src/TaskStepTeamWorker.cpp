@@ -0,0 +1,60 @@
+#include "TaskStepTeamWorker.h"
+#include "Tags.h"
+#include <algorithm>
+
+TaskStepTeamWorker::TaskStepTeamWorker(MPI_Comm comm, int teamSize,
+  std::function<void(int, int, int, MPI_Comm, MPI_Comm)> taskFunc,
+  const std::map<int, int>& stepBegMap,
+  const std::map<int, int>& stepEndMap) {
+    this->comm = comm;
+    this->taskFunc = taskFunc;
+    this->stepBegMap = stepBegMap;
+    this->stepEndMap = stepEndMap;
+    MPI_Comm_rank(comm, &this->rank);
+
+    // same grouping as TaskStepManager: ranks 1..teamSize, teamSize+1..2*teamSize, ...
+    int color = (this->rank == 0) ? MPI_UNDEFINED : (this->rank - 1) / teamSize;
+    MPI_Comm_split(comm, color, this->rank, &this->teamComm);
+}
+
+void
+TaskStepTeamWorker::run() const {
+
+    const int managerRank = 0;
+    int teamRank;
+    MPI_Comm_rank(this->teamComm, &teamRank);
+
+    while (true) {
+
+        // The leader gets the task_id to operate on, -1 for shutdown
+        int task_id;
+        if (teamRank == 0) {
+            MPI_Status recv_status;
+            MPI_Recv(&task_id, 1, MPI_INT, managerRank, MPI_ANY_TAG, this->comm, &recv_status);
+            if (recv_status.MPI_TAG == SHUTDOWN_TAG) task_id = -1;
+        }
+        MPI_Bcast(&task_id, 1, MPI_INT, 0, this->teamComm);
+
+        if (task_id < 0) {
+            break;
+        }
+
+        int stepBeg = this->stepBegMap.at(task_id);
+        int stepEnd = this->stepEndMap.at(task_id);
+
+        // All the team members perform the task
+        this->taskFunc(task_id, stepBeg, stepEnd, this->comm, this->teamComm);
+
+        // Notify the manager that this team is available again
+        if (teamRank == 0) {
+            int done = 1;
+            MPI_Send(&done, 1, MPI_INT, managerRank, WORKER_AVAILABLE_TAG, this->comm);
+        }
+    }
+}
+
+int
+TaskStepTeamWorker::chooseTeamSize(long long numGridPoints, long long maxPointsPerRank, int numWorkers) {
+    long long k = (numGridPoints + maxPointsPerRank - 1) / std::max(1LL, maxPointsPerRank);
+    return (int) std::max(1LL, std::min(k, (long long) std::max(1, numWorkers)));
+}
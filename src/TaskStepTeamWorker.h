@@ -0,0 +1,109 @@
+#include <mpi.h>
+#include <functional>
+#include <map>
+
+#ifndef TASK_STEP_TEAM_WORKER
+#define TASK_STEP_TEAM_WORKER
+
+/**
+ * Class TaskStepTeamWorker
+ * @brief A team of ranks executing together the tasks assigned by the TaskStepManager.
+ *
+ * @details Use this when a single rank cannot hold or solve a task fast enough, e.g. the
+ *          ADRE of a cohort on a 1/12 degree grid. The worker ranks 1..size-1 are split into
+ *          consecutive teams of teamSize ranks. The first rank of each team (the leader)
+ *          receives the task Ids from the manager and broadcasts them to its team; all the
+ *          team members then call the task function with the team communicator, inside
+ *          which the spatial domain can be decomposed.
+ *
+ *          Only the leader (rank 0 of the team communicator) should notify the manager at
+ *          the end of each step. The manager must be told the team size with
+ *          TaskStepManager::setTeamSize.
+ *
+ * @see TaskStepManager
+ */
+class TaskStepTeamWorker {
+
+    private:
+
+        // communicator
+        MPI_Comm comm;
+
+        // communicator of the team, MPI_COMM_NULL on the manager rank
+        MPI_Comm teamComm;
+
+        // task function, takes task_id, stepBeg, stepEnd, comm and teamComm
+        std::function<void(int, int, int, MPI_Comm, MPI_Comm)> taskFunc;
+
+        // task Id to first step index map
+        std::map<int, int> stepBegMap;
+
+        // task Id to last step index + 1 map
+        std::map<int, int> stepEndMap;
+
+        // local rank
+        int rank;
+
+    public:
+
+        /**
+         * Constructor, collective over comm (including the manager rank)
+         * @param comm MPI communicator
+         * @param teamSize number of ranks per team
+         * @param taskFunc task function takes task_id, stepBeg, stepEnd, the MPI communicator
+         *                 and the team communicator as input arguments. The team leader should
+         *                 notify the manager at the end of each step, ie
+         *                 MPI_Send({task_id, step, result}, 3, MPI_INT, managerRank, END_TASK_TAG, comm);
+         * @param stepBegMap map of task Id to first step index
+         * @param stepEndMap map of task Id to last step index + 1
+         */
+        TaskStepTeamWorker(MPI_Comm comm, int teamSize,
+            std::function<void(int, int, int, MPI_Comm, MPI_Comm)> taskFunc,
+            const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap);
+
+        /**
+         * Destructor, frees the team communicator if free has not been called and MPI
+         * is not finalized (freeing a communicator after MPI_Finalize is erroneous)
+         */
+        ~TaskStepTeamWorker() {
+            int finalized;
+            MPI_Finalized(&finalized);
+            if (!finalized) this->free();
+        }
+
+        /**
+         * Free the team communicator, call before MPI_Finalize
+         */
+        void free() {
+            if (this->teamComm != MPI_COMM_NULL) {
+                MPI_Comm_free(&this->teamComm);
+            }
+        }
+
+        TaskStepTeamWorker(const TaskStepTeamWorker&) = delete;
+        TaskStepTeamWorker& operator=(const TaskStepTeamWorker&) = delete;
+
+        /**
+         * Get the team communicator
+         * @return communicator, MPI_COMM_NULL on the manager rank
+         */
+        MPI_Comm getTeamComm() const { return this->teamComm; }
+
+        /**
+         * Run the tasks assigned by the TaskStepManager, call on all the worker ranks
+         */
+        void run() const;
+
+        /**
+         * Choose the team size from the grid size
+         * @param numGridPoints number of grid points of a task (e.g. nlon * nlat)
+         * @param maxPointsPerRank number of grid points one rank can hold and solve in time
+         * @param numWorkers number of worker ranks
+         * @return number of ranks per team, between 1 and numWorkers
+         */
+        static int chooseTeamSize(long long numGridPoints, long long maxPointsPerRank, int numWorkers);
+
+};
+
+#endif // TASK_STEP_TEAM_WORKER
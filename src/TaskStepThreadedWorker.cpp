@@ -0,0 +1,88 @@
+#include "TaskStepThreadedWorker.h"
+#include "Tags.h"
+#include "Trace.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <iostream>
+
+TaskStepThreadedWorker::TaskStepThreadedWorker(MPI_Comm comm, int numSlots,
+  std::function<void(int, int, int, MPI_Comm)> taskFunc,
+  const std::map<int, int>& stepBegMap,
+  const std::map<int, int>& stepEndMap) {
+    this->comm = comm;
+    this->numSlots = numSlots;
+    this->taskFunc = taskFunc;
+    this->stepBegMap = stepBegMap;
+    this->stepEndMap = stepEndMap;
+    MPI_Comm_rank(comm, &this->rank);
+
+    int provided;
+    MPI_Query_thread(&provided);
+    if (numSlots > 1 && provided < MPI_THREAD_MULTIPLE) {
+        std::cerr << "Error: TaskStepThreadedWorker requires MPI_Init_thread with MPI_THREAD_MULTIPLE\n";
+        MPI_Abort(comm, 1);
+    }
+}
+
+void
+TaskStepThreadedWorker::run() const {
+
+    const int managerRank = 0;
+
+    // tasks received but not yet started, -1 signals the shutdown
+    std::deque<int> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    auto threadLoop = [&]() {
+        while (true) {
+            int task_id;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&]() { return !tasks.empty(); });
+                task_id = tasks.front();
+                if (task_id < 0) return; // leave the shutdown marker for the other threads
+                tasks.pop_front();
+            }
+
+            int stepBeg = this->stepBegMap.at(task_id);
+            int stepEnd = this->stepEndMap.at(task_id);
+            {
+                SEAPODYM_TRACE_SCOPE(TRACE_TASK_RUN, task_id, stepBeg, managerRank);
+                this->taskFunc(task_id, stepBeg, stepEnd, this->comm);
+            }
+
+            // Notify the manager that a slot is available again
+            int done = 1;
+            MPI_Send(&done, 1, MPI_INT, managerRank, WORKER_AVAILABLE_TAG, this->comm);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < this->numSlots; ++i) threads.emplace_back(threadLoop);
+
+    while (true) {
+        int task_id;
+        MPI_Status recv_status;
+        {
+            SEAPODYM_TRACE_NAMED_SCOPE(recvScope, TRACE_TASK_RECV, -1, -1, managerRank);
+            MPI_Recv(&task_id, 1, MPI_INT, managerRank, MPI_ANY_TAG, this->comm, &recv_status);
+            SEAPODYM_TRACE_SET_TASK(recvScope, task_id);
+        }
+        bool shutdown = (recv_status.MPI_TAG == SHUTDOWN_TAG);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(shutdown ? -1 : task_id);
+        }
+        if (shutdown) {
+            cv.notify_all();
+            break;
+        }
+        cv.notify_one();
+    }
+
+    for (auto& t : threads) t.join();
+}
@@ -0,0 +1,74 @@
+#include <mpi.h>
+#include <functional>
+#include <map>
+
+#ifndef TASK_STEP_THREADED_WORKER
+#define TASK_STEP_THREADED_WORKER
+
+/**
+ * Class TaskStepThreadedWorker
+ * @brief A worker running up to numSlots tasks concurrently, in threads of the same process.
+ *
+ * @details Compared to running one single threaded TaskStepWorker per core, the read-only
+ *          data (forcing, grid, maps, parameters) are shared by the threads rather than
+ *          replicated in every process. MPI must be initialized with MPI_THREAD_MULTIPLE
+ *          since the task function sends END_TASK_TAG from the thread that runs the task.
+ *
+ *          The main thread receives the tasks from the manager and hands them to a pool
+ *          of numSlots threads. Each thread sends WORKER_AVAILABLE_TAG when its task is
+ *          done, so the manager, told the number of slots with
+ *          TaskStepManager::setWorkerSlots, sees a worker with numSlots free slots.
+ *
+ *          The task function must be thread safe. DistDataCollector::put, get and
+ *          accumulate can be called from several threads.
+ *
+ * @see TaskStepManager
+ */
+class TaskStepThreadedWorker {
+
+    private:
+
+        // communicator
+        MPI_Comm comm;
+
+        // number of threads
+        int numSlots;
+
+        // task function, takes task_id, stepBeg, stepEnd and comm
+        std::function<void(int, int, int, MPI_Comm)> taskFunc;
+
+        // task Id to first step index map
+        std::map<int, int> stepBegMap;
+
+        // task Id to last step index + 1 map
+        std::map<int, int> stepEndMap;
+
+        // local rank
+        int rank;
+
+    public:
+
+        /**
+         * Constructor
+         * @param comm MPI communicator
+         * @param numSlots number of tasks run concurrently
+         * @param taskFunc thread safe task function, takes task_id, stepBeg, stepEnd and the
+         *                 MPI communicator as input arguments. This function should notify the
+         *                 manager at the end of each step, ie
+         *                 MPI_Send({task_id, step, result}, 3, MPI_INT, managerRank, END_TASK_TAG, comm);
+         * @param stepBegMap map of task Id to first step index
+         * @param stepEndMap map of task Id to last step index + 1
+         */
+        TaskStepThreadedWorker(MPI_Comm comm, int numSlots,
+            std::function<void(int, int, int, MPI_Comm)> taskFunc,
+            const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap);
+
+        /**
+         * Run the tasks assigned by the TaskStepManager
+         */
+        void run() const;
+
+};
+
+#endif // TASK_STEP_THREADED_WORKER
@@ -1,6 +1,8 @@
 #include "TaskStepWorker.h"
 #include "Tags.h"
+#include "Trace.h"
 #include <array>
+#include <thread>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
@@ -14,6 +16,14 @@ TaskStepWorker::TaskStepWorker(MPI_Comm comm,
     this->stepEndMap = stepEndMap;
     MPI_Comm_rank(comm, &this->rank);
 }
+
+TaskStepWorker::TaskStepWorker(MPI_Comm comm,
+  std::function<void(int, MPI_Comm)> initFunc,
+  std::function<void(int, int, int, MPI_Comm)> taskFunc,
+  const std::map<int, int>& stepBegMap,
+  const std::map<int, int>& stepEndMap) : TaskStepWorker(comm, taskFunc, stepBegMap, stepEndMap) {
+    this->initFunc = initFunc;
+}
         
 void
 TaskStepWorker::run() const {
@@ -21,17 +31,45 @@ TaskStepWorker::run() const {
     const int managerRank = 0;
 
     std::string sworkerId = std::to_string(this->rank);
-    // Use true to let logs be overwritten, otherwise the logs will be appended
-    auto logger = spdlog::basic_logger_mt(sworkerId, "log_worker" + sworkerId + ".txt", true);
+    // Use true to let logs be overwritten, otherwise the logs will be appended.
+    // The logger is reused if run is called again, e.g. by TaskStepService
+    auto logger = spdlog::get(sworkerId);
+    if (!logger) {
+        logger = spdlog::basic_logger_mt(sworkerId, "log_worker" + sworkerId + ".txt", true);
+    }
     logger->set_level(spdlog::level::debug);
     logger->info("Starting loop");
+
+    // task already initialized ahead of its dependencies, -1 if none
+    int preparedTask = -1;
+
     while (true) {
 
-        // Get the task_id to operate on
-        int task_id;
+        // Get the task_id to operate on, and the first step if the task is resumed
+        std::array<int, 2> msg;
         logger->info("Waiting for manager to send a task...");
         MPI_Status recv_status;
-        MPI_Recv(&task_id, 1, MPI_INT, managerRank, MPI_ANY_TAG, this->comm, &recv_status);
+        {
+            SEAPODYM_TRACE_NAMED_SCOPE(recvScope, TRACE_TASK_RECV, -1, -1, managerRank);
+            if (this->rank == managerRank) {
+                // colocated with the manager thread: the END_TASK_TAG messages sent
+                // by this rank to the manager must not be matched here
+                const int tags[] = {START_TASK_TAG, RESUME_TASK_TAG, PREPARE_TASK_TAG, CANCEL_TASK_TAG, SHUTDOWN_TAG};
+                int flag = 0;
+                while (!flag) {
+                    for (int tag : tags) {
+                        MPI_Iprobe(managerRank, tag, this->comm, &flag, &recv_status);
+                        if (flag) break;
+                    }
+                    if (!flag) std::this_thread::yield();
+                }
+                MPI_Recv(msg.data(), 2, MPI_INT, managerRank, recv_status.MPI_TAG, this->comm, &recv_status);
+            } else {
+                MPI_Recv(msg.data(), 2, MPI_INT, managerRank, MPI_ANY_TAG, this->comm, &recv_status);
+            }
+            SEAPODYM_TRACE_SET_TASK(recvScope, msg[0]);
+        }
+        int task_id = msg[0];
         logger->info("Received task {}", task_id);
 
         if (recv_status.MPI_TAG == SHUTDOWN_TAG) {
@@ -40,13 +78,42 @@ TaskStepWorker::run() const {
             break;
         }
 
+        if (recv_status.MPI_TAG == CANCEL_TASK_TAG) {
+            // the task was already finished when its cancellation arrived
+            logger->info("Discarding the cancellation of task {}", task_id);
+            continue;
+        }
+
+        if (recv_status.MPI_TAG == PREPARE_TASK_TAG) {
+            // initialize while the dependencies complete, START_TASK_TAG follows
+            logger->info("Initializing task {}", task_id);
+            if (this->initFunc) {
+                SEAPODYM_TRACE_SCOPE(TRACE_TASK_INIT, task_id, -1);
+                this->initFunc(task_id, this->comm);
+            }
+            preparedTask = task_id;
+            continue;
+        }
+        if (this->initFunc && task_id != preparedTask) {
+            SEAPODYM_TRACE_SCOPE(TRACE_TASK_INIT, task_id, -1);
+            this->initFunc(task_id, this->comm);
+        }
+        preparedTask = -1;
+
         int stepBeg = this->stepBegMap.at(task_id);
         int stepEnd = this->stepEndMap.at(task_id);
+        if (recv_status.MPI_TAG == RESUME_TASK_TAG) {
+            // duplicate of a straggling task, from its first uncompleted step
+            stepBeg = msg[1];
+        }
 
         // Perform the task, which includes stepping from stepBeg to stepEnd - 1.
         // This function should notify the manager at the end of each step
         logger->info("Running task {} from step {} to {}", task_id, stepBeg, stepEnd);
-        this->taskFunc(task_id, stepBeg, stepEnd, this->comm);
+        {
+            SEAPODYM_TRACE_SCOPE(TRACE_TASK_RUN, task_id, stepBeg, managerRank);
+            this->taskFunc(task_id, stepBeg, stepEnd, this->comm);
+        }
         logger->info("Finished task {}", task_id);
 
         // Notify the manager that this worker is available again
@@ -57,3 +124,16 @@ TaskStepWorker::run() const {
     }
  
 }
+
+bool
+TaskStepWorker::isCancelled(MPI_Comm comm, int task_id) {
+    const int managerRank = 0;
+    int flag = 0;
+    while (true) {
+        MPI_Iprobe(managerRank, CANCEL_TASK_TAG, comm, &flag, MPI_STATUS_IGNORE);
+        if (!flag) return false;
+        int cancelled;
+        MPI_Recv(&cancelled, 1, MPI_INT, managerRank, CANCEL_TASK_TAG, comm, MPI_STATUS_IGNORE);
+        if (cancelled == task_id) return true;
+    }
+}
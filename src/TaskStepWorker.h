@@ -10,6 +10,10 @@
  * @brief The TaskStepWorker gets tasks assigned from the TaskStepManager and executes them.
  * 
  * @details A task involves running multiple steps and the worker will inform the manager after each step is complete.
+ *          A worker can also run on the manager rank, see TaskStepManager::setColocatedWorker.
+ *          With speculation (TaskStepManager::setSpeculation) the worker may be asked to resume
+ *          a task from a later step (RESUME_TASK_TAG), and the task function should call
+ *          isCancelled between steps to stop running a task whose duplicate has won.
  * 
  * @see TaskStepManager
  */
@@ -25,6 +29,9 @@ class TaskStepWorker {
         // and returns a code/result
         std::function<void(int, int, int, MPI_Comm)> taskFunc;
 
+        // optional initialization function, takes task_id, may run before the dependencies are met
+        std::function<void(int, MPI_Comm)> initFunc;
+
         // task Id to first step index map
         std::map<int, int> stepBegMap;
 
@@ -51,11 +58,38 @@ class TaskStepWorker {
             const std::map<int, int>& stepBegMap,
             const std::map<int, int>& stepEndMap);
 
+        /**
+         * Constructor with a separate initialization function
+         * @param comm MPI communicator
+         * @param initFunc initialization function, takes task_id and the MPI communicator. It
+         *                 must not depend on the data of the other tasks: with
+         *                 TaskStepManager::setEarlyInit it runs as soon as the task is assigned
+         *                 (PREPARE_TASK_TAG), possibly before its dependencies are complete.
+         *                 Otherwise it runs right before taskFunc.
+         * @param taskFunc task function, see above
+         * @param stepBegMap map of task Id to first step index
+         * @param stepEndMap map of task Id to last step index + 1
+         */
+        TaskStepWorker(MPI_Comm comm,
+            std::function<void(int, MPI_Comm)> initFunc,
+            std::function<void(int, int, int, MPI_Comm)> taskFunc,
+            const std::map<int, int>& stepBegMap,
+            const std::map<int, int>& stepEndMap);
+
         /**
          * Run the tasks assigned by the TaskManager
          */
         void run() const;
 
+        /**
+         * Check whether the manager has cancelled a task, call from the task function
+         * between steps. Cancellation messages of other (finished) tasks are discarded.
+         * @param comm MPI communicator
+         * @param task_id task being executed
+         * @return true if the task function should return without running the remaining steps
+         */
+        static bool isCancelled(MPI_Comm comm, int task_id);
+
 };
 
 #endif // TASK_STEP_WORKER
@@ -1,10 +1,22 @@
 #include "TaskWorker.h"
 #include "Tags.h"
+#include "DistDataCollector.h"
+#include <vector>
+#include <cstring>
+#include <string>
+#include <stdexcept>
 
 TaskWorker::TaskWorker(MPI_Comm comm, std::function<int(int)> taskFunc) {
     this->comm = comm;
     this->taskFunc = taskFunc;
 }
+
+TaskWorker::TaskWorker(MPI_Comm comm, std::function<std::vector<double>(int)> payloadFunc,
+                       DistDataCollector* collector) {
+    this->comm = comm;
+    this->payloadFunc = payloadFunc;
+    this->collector = collector;
+}
         
 void
 TaskWorker::run() const {
@@ -13,22 +25,66 @@ TaskWorker::run() const {
     int workerId;
     MPI_Comm_rank(this->comm, &workerId);
 
-    int taskId;
+    int msg[2];
+    std::vector<int> results;
+    std::vector<double> records;
 
     while (true) {
 
-        // get the assigned task
-        int ier = MPI_Recv(&taskId, 1, MPI_INT, manager_rank, START_TASK_TAG, this->comm, MPI_STATUS_IGNORE);
-        
+        // get the assigned task or range of tasks
+        MPI_Status status;
+        int count;
+        int ier = MPI_Probe(manager_rank, START_TASK_TAG, this->comm, &status);
+        MPI_Get_count(&status, MPI_INT, &count);
+        ier = MPI_Recv(msg, count, MPI_INT, manager_rank, START_TASK_TAG, this->comm, MPI_STATUS_IGNORE);
+        int taskId = msg[0];
+
         if (taskId < 0) {
             // No more tasks
             break;
         }
 
-        // execute the task
-        int result = this->taskFunc(taskId);
+        if (count == 1) {
+            // a single task Id expects an int result (TaskDependencyManager)
+            if (!this->taskFunc) {
+                throw std::invalid_argument("TaskWorker: payload tasks must be assigned as ranges (TaskManager)");
+            }
+            // execute the task, send back the task Id and the result
+            int output[2] = {taskId, this->taskFunc(taskId)};
+            ier = MPI_Send(output, 2, MPI_INT, manager_rank, END_TASK_TAG, this->comm);
+            continue;
+        }
+
+        if (this->payloadFunc) {
+            // execute the range, send back one record per task
+            records.clear();
+            for (int id = msg[0]; id < msg[1]; ++id) {
+                std::vector<double> payload = this->payloadFunc(id);
+                int header[2] = {id, this->collector ? -1 : (int) payload.size()};
+                records.push_back(0);
+                std::memcpy(&records.back(), header, sizeof(header));
+                if (this->collector) {
+                    if (payload.size() != this->collector->getNumSize()) {
+                        throw std::length_error("TaskWorker: payload of task " + std::to_string(id) +
+                            " has " + std::to_string(payload.size()) + " values, the collector chunks " +
+                            std::to_string(this->collector->getNumSize()));
+                    }
+                    this->collector->put(id, payload.data());
+                } else {
+                    records.insert(records.end(), payload.begin(), payload.end());
+                }
+            }
+            ier = MPI_Send(records.data(), (int) (records.size() * sizeof(double)), MPI_BYTE,
+                           manager_rank, END_TASK_TAG, this->comm);
+            continue;
+        }
 
-        // send the result, use the taskId as tag
-        ier = MPI_Send(&result, 1, MPI_INT, manager_rank, taskId,  this->comm);
+        // execute the range, send back the first task Id followed by the results
+        results.resize(msg[1] - msg[0] + 1);
+        results[0] = msg[0];
+        for (int id = msg[0]; id < msg[1]; ++id) {
+            results[id - msg[0] + 1] = this->taskFunc(id);
+        }
+        ier = MPI_Send(results.data(), (int) results.size(), MPI_INT, manager_rank, END_TASK_TAG, this->comm);
     }
 }
@@ -1,5 +1,8 @@
 #include <mpi.h>
 #include <functional>
+#include <vector>
+
+class DistDataCollector;
 
 #ifndef TASK_WORKER
 #define TASK_WORKER
@@ -7,6 +10,17 @@
 /**
  * Class TaskWorker
  * @brief The TaskWorker gets tasks assigned and executes them.
+ *
+ * @details A single task Id (TaskDependencyManager) is answered with {taskId, result}, a
+ *          [begin, end) range of task Ids (TaskManager) with {begin, results...}, both tagged
+ *          with END_TASK_TAG. A negative task Id stops the worker.
+ *
+ *          With a payload function, each task of a range returns a vector of doubles and the
+ *          range is answered with a single MPI_BYTE message of records
+ *          {int taskId, int numValues, double values[numValues]} (the header takes the size of
+ *          one double so that the values stay aligned). If a DistDataCollector is given, the
+ *          values are put into its chunk taskId instead and numValues is -1.
+ *          See TaskManager::run(handler).
  */
 
 class TaskWorker {
@@ -19,6 +33,12 @@ class TaskWorker {
         // Task function
         std::function<int(int)> taskFunc;
 
+        // Task function returning a payload, if set
+        std::function<std::vector<double>(int)> payloadFunc;
+
+        // collector receiving the payloads, if any (not owned)
+        DistDataCollector* collector = nullptr;
+
     public:
 
         /**
@@ -28,6 +48,20 @@ class TaskWorker {
          */
         TaskWorker(MPI_Comm comm, std::function<int(int)> taskFunc);
 
+        /**
+         * Constructor for tasks returning payloads
+         * @param comm MPI communicator
+         * @param payloadFunc task function returning any number of values
+         * @param collector if not nullptr, the values of task taskId are put into chunk taskId
+         *                  of this collector (the payload must then have its chunk size) and
+         *                  only the task Id is sent to the manager
+         * @note the tasks must be assigned as ranges (TaskManager): run throws
+         *       std::invalid_argument on a single task Id (TaskDependencyManager), and
+         *       std::length_error if a payload does not have the chunk size of the collector
+         */
+        TaskWorker(MPI_Comm comm, std::function<std::vector<double>(int)> payloadFunc,
+                   DistDataCollector* collector = nullptr);
+
         /**
          * Run the tasks assigned by the TaskManager
          */
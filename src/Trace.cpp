@@ -0,0 +1,96 @@
+#include "Trace.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+
+namespace {
+
+// shared state, the mutex is only taken when a thread records its first event
+// and when flushing
+std::mutex traceMutex;
+std::vector<std::unique_ptr<Trace::Buffer>> traceBuffers;
+std::size_t traceCapacity = 65536;
+std::chrono::steady_clock::time_point traceOrigin = std::chrono::steady_clock::now();
+int traceRank = 0;
+
+} // namespace
+
+void
+Trace::init(MPI_Comm comm, std::size_t capacity) {
+
+    std::size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    MPI_Comm_rank(comm, &traceRank);
+    {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceCapacity = cap;
+    }
+
+    // common time origin across ranks, up to the barrier skew
+    MPI_Barrier(comm);
+    traceOrigin = std::chrono::steady_clock::now();
+}
+
+std::int64_t
+Trace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - traceOrigin).count();
+}
+
+Trace::Buffer*
+Trace::registerThread() {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    auto buf = std::make_unique<Buffer>();
+    buf->events.resize(traceCapacity);
+    buf->threadIndex = static_cast<int>(traceBuffers.size());
+    traceBuffers.push_back(std::move(buf));
+    return traceBuffers.back().get();
+}
+
+void
+Trace::flush(const std::string& prefix) {
+
+    std::lock_guard<std::mutex> lock(traceMutex);
+
+    std::string filename = prefix + "_rank" + std::to_string(traceRank) + ".bin";
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: unable to write trace file " << filename << '\n';
+        return;
+    }
+
+    // header: magic, rank, number of threads
+    const char magic[8] = {'S', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+    std::int32_t rank = traceRank;
+    std::int32_t numThreads = static_cast<std::int32_t>(traceBuffers.size());
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&rank), sizeof(rank));
+    out.write(reinterpret_cast<const char*>(&numThreads), sizeof(numThreads));
+
+    // then for each thread: index, padding, number of events, number of dropped events, events
+    for (const auto& buf : traceBuffers) {
+        std::uint64_t head = buf->head.load(std::memory_order_acquire);
+        std::uint64_t capacity = buf->events.size();
+        std::int64_t numEvents = static_cast<std::int64_t>(std::min(head, capacity));
+        std::int64_t numDropped = static_cast<std::int64_t>(head) - numEvents;
+        std::int32_t tid = buf->threadIndex;
+        std::int32_t pad = 0;
+        out.write(reinterpret_cast<const char*>(&tid), sizeof(tid));
+        out.write(reinterpret_cast<const char*>(&pad), sizeof(pad));
+        out.write(reinterpret_cast<const char*>(&numEvents), sizeof(numEvents));
+        out.write(reinterpret_cast<const char*>(&numDropped), sizeof(numDropped));
+        // oldest event first
+        for (std::uint64_t i = head - numEvents; i < head; ++i) {
+            const TraceEvent& ev = buf->events[i & (capacity - 1)];
+            out.write(reinterpret_cast<const char*>(&ev), sizeof(TraceEvent));
+        }
+        if (numDropped > 0) {
+            std::cerr << "Warning: rank " << traceRank << " thread " << tid << " dropped "
+                      << numDropped << " trace events, increase the capacity in Trace::init\n";
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include <mpi.h>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifndef SEAPODYM_TRACE_H
+#define SEAPODYM_TRACE_H
+
+/**
+ * @brief Types of events recorded by Trace
+ */
+enum TraceEventType : std::int32_t {
+    TRACE_TASK_RECV = 0,       // worker waiting for/receiving a task from the manager
+    TRACE_TASK_RUN = 1,        // worker executing all the steps of a task
+    TRACE_TASK_INIT = 2,       // task initialisation, before the first step
+    TRACE_STEP_COMPUTE = 3,    // computation of one step
+    TRACE_PUT = 4,             // RMA put, taskId is the chunk Id and value the number of bytes
+    TRACE_GET = 5,             // RMA get, taskId is the chunk Id and value the number of bytes
+    TRACE_ACCUMULATE = 6,      // RMA accumulate, taskId is the chunk Id and value the number of bytes
+    TRACE_END_TASK_SEND = 7,   // END_TASK_TAG message sent to the manager
+    TRACE_DISPATCH = 8,        // manager sending a task to a worker (peer)
+    TRACE_QUEUE_DEPTH = 9,     // manager counter, value is the number of tasks not yet dispatched
+};
+
+/**
+ * @brief Fixed-size binary trace event (40 bytes)
+ */
+struct TraceEvent {
+    // begin and end times in nanoseconds since Trace::init
+    std::int64_t tBeg;
+    std::int64_t tEnd;
+    // bytes transferred, counter value, ...
+    std::int64_t value;
+    std::int32_t type;
+    std::int32_t taskId;
+    std::int32_t step;
+    // other rank involved, -1 if none
+    std::int32_t peer;
+};
+static_assert(sizeof(TraceEvent) == 40, "TraceEvent layout is read by scripts/trace2chrome.py");
+
+/**
+ * @brief Low overhead timeline tracing
+ *
+ * @details Each thread appends events to its own ring buffer, so recording an event
+ *          involves no lock and no system call. When a buffer is full the oldest events
+ *          are overwritten. Trace::flush writes the buffers of all the threads of this rank
+ *          to <prefix>_rank<N>.bin, which scripts/trace2chrome.py converts to the Chrome
+ *          trace JSON format (chrome://tracing, Perfetto).
+ *
+ *          Use the SEAPODYM_TRACE_* macros rather than calling this class directly. The
+ *          macros expand to nothing unless the code is compiled with -DSEAPODYM_TRACE
+ *          (cmake -DTRACE=ON).
+ */
+class Trace {
+
+    public:
+
+        /**
+         * Per-thread ring buffer
+         */
+        struct Buffer {
+            std::vector<TraceEvent> events;
+            // total number of events recorded, events[head % capacity] is the next slot
+            std::atomic<std::uint64_t> head{0};
+            int threadIndex = 0;
+        };
+
+        /**
+         * Start tracing, collective over comm. The ranks synchronize so that their
+         * clocks have a common origin
+         * @param comm communicator
+         * @param capacity number of events kept per thread (rounded up to a power of 2)
+         */
+        static void init(MPI_Comm comm, std::size_t capacity = 65536);
+
+        /**
+         * Get the time
+         * @return nanoseconds since init
+         */
+        static std::int64_t now();
+
+        /**
+         * Record an event in the calling thread's buffer
+         */
+        static void record(TraceEventType type, std::int64_t tBeg, std::int64_t tEnd,
+                           int taskId = -1, int step = -1, int peer = -1, std::int64_t value = 0) {
+            Buffer* buf = threadBuffer();
+            std::uint64_t h = buf->head.load(std::memory_order_relaxed);
+            buf->events[h & (buf->events.size() - 1)] = TraceEvent{tBeg, tEnd, value, type, taskId, step, peer};
+            buf->head.store(h + 1, std::memory_order_release);
+        }
+
+        /**
+         * Write the events of all the threads of this rank to <prefix>_rank<N>.bin.
+         * Call this once the traced threads have stopped recording.
+         * @param prefix file name prefix
+         */
+        static void flush(const std::string& prefix = "trace");
+
+    private:
+
+        // get (or create) the calling thread's buffer
+        static Buffer* threadBuffer() {
+            thread_local Buffer* buf = registerThread();
+            return buf;
+        }
+
+        static Buffer* registerThread();
+};
+
+/**
+ * @brief Record an event spanning the lifetime of this object
+ */
+class TraceScope {
+    public:
+        TraceScope(TraceEventType type, int taskId = -1, int step = -1, int peer = -1, std::int64_t value = 0)
+            : type(type), taskId(taskId), step(step), peer(peer), value(value), tBeg(Trace::now()) {}
+        ~TraceScope() {
+            Trace::record(type, tBeg, Trace::now(), taskId, step, peer, value);
+        }
+        // update the task Id, e.g. once a task has been received
+        void setTaskId(int id) { this->taskId = id; }
+    private:
+        TraceEventType type;
+        int taskId;
+        int step;
+        int peer;
+        std::int64_t value;
+        std::int64_t tBeg;
+};
+
+#define SEAPODYM_TRACE_CAT2(a, b) a##b
+#define SEAPODYM_TRACE_CAT(a, b) SEAPODYM_TRACE_CAT2(a, b)
+
+#ifdef SEAPODYM_TRACE
+    #define SEAPODYM_TRACE_INIT(comm) Trace::init(comm)
+    #define SEAPODYM_TRACE_FLUSH(prefix) Trace::flush(prefix)
+    // record an event lasting until the end of the enclosing scope
+    #define SEAPODYM_TRACE_SCOPE(...) TraceScope SEAPODYM_TRACE_CAT(seapodymTraceScope, __LINE__)(__VA_ARGS__)
+    // named scope, whose task Id can be updated with SEAPODYM_TRACE_SET_TASK
+    #define SEAPODYM_TRACE_NAMED_SCOPE(name, ...) TraceScope name(__VA_ARGS__)
+    #define SEAPODYM_TRACE_SET_TASK(name, taskId) name.setTaskId(taskId)
+    // record an instantaneous event or a counter value
+    #define SEAPODYM_TRACE_EVENT(type, taskId, step, peer, value) \
+        do { std::int64_t seapodymTraceT = Trace::now(); \
+             Trace::record(type, seapodymTraceT, seapodymTraceT, taskId, step, peer, value); } while (0)
+#else
+    #define SEAPODYM_TRACE_INIT(comm) ((void)0)
+    #define SEAPODYM_TRACE_FLUSH(prefix) ((void)0)
+    #define SEAPODYM_TRACE_SCOPE(...) ((void)0)
+    #define SEAPODYM_TRACE_NAMED_SCOPE(name, ...) ((void)0)
+    #define SEAPODYM_TRACE_SET_TASK(name, taskId) ((void)0)
+    #define SEAPODYM_TRACE_EVENT(type, taskId, step, peer, value) ((void)0)
+#endif
+
+#endif // SEAPODYM_TRACE_H
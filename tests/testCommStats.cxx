@@ -0,0 +1,138 @@
+#include <mpi.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <ctime>
+#include <CmdLineArgParser.h>
+#include "CommStats.h"
+#include "DistDataCollector.h"
+#include "SeapodymCourier.h"
+#include "DataProvider.h"
+#undef NDEBUG
+#include <cassert>
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Count the RMA operations, bytes and latencies and write them to a per-rank CSV file.");
+    cmdLine.set("-nd", 1000, "Number of values per chunk");
+    cmdLine.set("-nc", 5, "Number of chunks per rank");
+    cmdLine.set("-prefix", std::string("testCommStats"), "Prefix of the CSV files");
+    cmdLine.set("-nr", 1000000, "Number of operations counted to measure the overhead");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int nd = cmdLine.get<int>("-nd");
+    int nc = cmdLine.get<int>("-nc");
+    int nr = cmdLine.get<int>("-nr");
+    std::string prefix = cmdLine.get<std::string>("-prefix");
+
+    // the counters are written at MPI_Finalize
+    SEAPODYM_COMM_STATS_INIT(MPI_COMM_WORLD, prefix);
+
+    {
+        DataProvider provider(MPI_COMM_WORLD, {{"forcing", (std::size_t) nd}});
+
+        DistDataCollector collector(MPI_COMM_WORLD, (std::size_t) nc * size, nd);
+        std::vector<double> data(nd, double(rank));
+        for (int i = 0; i < nc; ++i) collector.put(rank * nc + i, data.data());
+        MPI_Barrier(MPI_COMM_WORLD);
+        for (int i = 0; i < nc; ++i) collector.get(((rank + 1) % size) * nc + i, data.data());
+        collector.free();
+
+        SeapodymCourier courier(MPI_COMM_WORLD);
+        courier.expose(data.data(), nd);
+        MPI_Barrier(MPI_COMM_WORLD);
+        courier.fetch((rank + 1) % size);
+        MPI_Barrier(MPI_COMM_WORLD);
+        courier.free();
+    }
+
+#ifdef SEAPODYM_COMM_STATS
+    CommStats::Entry puts = CommStats::getTotal(COMM_PUT);
+    CommStats::Entry gets = CommStats::getTotal(COMM_GET);
+    CommStats::Entry locks = CommStats::getTotal(COMM_LOCK);
+    assert(puts.count == (std::uint64_t) nc);
+    assert(puts.bytes == (std::uint64_t) nc * nd * sizeof(double));
+    // collector gets, then one courier fetch unless fetching from self
+    assert(gets.count == (std::uint64_t) nc + (size > 1 ? 1 : 0));
+    assert(locks.count == puts.count + gets.count);
+    std::uint64_t numInHistogram = 0;
+    for (auto n : puts.histogram) numInHistogram += n;
+    assert(numInHistogram == puts.count);
+
+    // overhead of the accounting, empty counted operations (CPU time, the ranks may
+    // share cores)
+    std::clock_t tic = std::clock();
+    for (int i = 0; i < nr; ++i) {
+        CommStatsScope scope(COMM_FENCE);
+    }
+    double overhead = double(std::clock() - tic) / CLOCKS_PER_SEC / nr;
+    if (rank == 0) {
+        std::cout << "Overhead: " << overhead * 1.e9 << " ns per counted operation, mean put: "
+                  << double(puts.ns) / double(puts.count) << " ns\n";
+    }
+
+    // the counters can be read while another thread counts
+    std::atomic<bool> done(false);
+    std::thread counting([&]() {
+        for (int i = 0; i < nr; ++i) {
+            CommStatsScope scope(COMM_FENCE);
+        }
+        done = true;
+    });
+    while (!done) {
+        assert(CommStats::getTotal(COMM_FENCE).count <= 2 * (std::uint64_t) nr);
+    }
+    counting.join();
+    assert(CommStats::getTotal(COMM_FENCE).count == 2 * (std::uint64_t) nr);
+    bool enabled = true;
+#else
+    bool enabled = false;
+#endif
+
+    MPI_Finalize();
+
+    // the file written at MPI_Finalize has one row per operation type and target
+    if (rank == 0) {
+        if (enabled) {
+            std::ifstream in(prefix + "_rank0.csv");
+            std::string line;
+            std::getline(in, line);
+            assert(line.rfind("rank,op,target,count,bytes,seconds,hist_0", 0) == 0);
+            int numRows = 0;
+            bool foundPut = false;
+            while (std::getline(in, line)) {
+                ++numRows;
+                if (line.rfind("0,put,0," + std::to_string(nc) + ",", 0) == 0) foundPut = true;
+            }
+            assert(foundPut);
+            std::cout << "Communication statistics: " << numRows << " rows in " << prefix << "_rank0.csv\n";
+        } else {
+            std::cout << "Communication statistics disabled\n";
+        }
+        std::cout << "Success\n";
+    }
+    return 0;
+}
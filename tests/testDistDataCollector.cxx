@@ -1,10 +1,13 @@
 #include <DistDataCollector.h>
 #include <iostream>
+#include <fstream>
+#include <memory>
+#include <cstdio>
 #include "CmdLineArgParser.h"
 #undef NDEBUG
 #include <cassert>
 
-void test(int numSize, int numChunksPerRank) {
+void test(int numSize, int numChunksPerRank, int numChunksPerSegment, const std::string& filename) {
 
     int rank, nprocs;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -12,7 +15,21 @@ void test(int numSize, int numChunksPerRank) {
 
     int numChunks = numChunksPerRank * nprocs;
 
-    DistDataCollector ddc(MPI_COMM_WORLD, numChunks, numSize);
+    // 0: one window, otherwise split the collection into windows of numChunksPerSegment chunks
+    std::size_t maxSegmentBytes = DistDataCollector::MAX_SEGMENT_BYTES;
+    if (numChunksPerSegment > 0) maxSegmentBytes = (std::size_t) numChunksPerSegment * numSize * sizeof(double);
+    // an empty file name keeps the collected data in memory
+    std::unique_ptr<DistDataCollector> ddcPtr(filename.empty() ?
+        new DistDataCollector(MPI_COMM_WORLD, numChunks, numSize, 0, maxSegmentBytes) :
+        new DistDataCollector(MPI_COMM_WORLD, numChunks, numSize, filename, 0, maxSegmentBytes));
+    DistDataCollector& ddc = *ddcPtr;
+    if (numChunksPerSegment > 0) {
+        assert(ddc.getNumSegments() == (std::size_t) (numChunks + numChunksPerSegment - 1) / numChunksPerSegment);
+    }
+    // a backing file is left sparse, the chunks read as zeros until they are put
+    if (rank == 0 && !filename.empty()) {
+        assert(ddc.getChunkPtr(numChunks - 1)[numSize - 1] == 0.0);
+    }
 
     double timePut = 0, timeGet = 0;
 
@@ -63,20 +80,34 @@ void test(int numSize, int numChunksPerRank) {
     if (rank == 0) {
         int numChunk = ddc.getNumChunks();
         int numSize = ddc.getNumSize();
-        double* data = ddc.getCollectedDataPtr();
         double checksum = 0;
         for (auto chunk = 0; chunk < numChunk; ++chunk) {
             std::cout << "chunk " << chunk << ": ";
+            const double* data = ddc.getChunkPtr(chunk);
             for (auto i = 0; i < numSize; ++i) {
-                //std::cout << data[chunk*numSize + i] << ", ";
-                checksum += data[chunk*numSize + i];
+                //std::cout << data[i] << ", ";
+                checksum += data[i];
             }
             std::cout << std::endl;
         }
-        std::cout << "checksum: " << checksum << std::endl;
+        std::cout << "segments: " << ddc.getNumSegments() << " checksum: " << checksum << std::endl;
         assert(checksum == numSize * numChunks * (numChunks - 1) / 2);
     }
 
+    // the backing file holds the chunks in order once the collector is freed
+    ddc.free();
+    if (rank == 0 && !filename.empty()) {
+        std::ifstream file(filename, std::ios::binary);
+        std::vector<double> archive((std::size_t) numChunks * numSize);
+        file.read(reinterpret_cast<char*>(archive.data()), archive.size() * sizeof(double));
+        assert(file.gcount() == (std::streamsize) (archive.size() * sizeof(double)));
+        for (std::size_t k = 0; k < archive.size(); ++k) {
+            assert(archive[k] == double(k / numSize));
+        }
+        std::cout << "file: " << filename << " verified" << std::endl;
+        std::remove(filename.c_str());
+    }
+
     double timePutTotal, timeGetTotal;
     MPI_Reduce(&timePut, &timePutTotal, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
     MPI_Reduce(&timeGet, &timeGetTotal, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
@@ -98,6 +129,8 @@ int main(int argc, char* argv[]) {
     CmdLineArgParser cmdLine;
     cmdLine.set("-numSize", 100000, "Size of the data to put/get");
     cmdLine.set("-numChunksPerRank", 1, "Number of chunks per rank");
+    cmdLine.set("-numChunksPerSegment", 0, "Number of chunks per window (0: a single window)");
+    cmdLine.set("-file", std::string(""), "Back the collected data with this file (empty: in memory)");
     bool success = cmdLine.parse(argc, argv);
     bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
     if (!success) {
@@ -114,9 +147,10 @@ int main(int argc, char* argv[]) {
 
     int numSize = cmdLine.get<int>("-numSize");
     int numChunksPerRank = cmdLine.get<int>("-numChunksPerRank");
+    int numChunksPerSegment = cmdLine.get<int>("-numChunksPerSegment");
 
     // Run the test
-    test(numSize, numChunksPerRank);
+    test(numSize, numChunksPerRank, numChunksPerSegment, cmdLine.get<std::string>("-file"));
 
     // Finalize the MPI environment
     MPI_Finalize();
@@ -0,0 +1,135 @@
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <CmdLineArgParser.h>
+#include "MultiFieldCollector.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Collect chunks of several fields in one window and fetch a subset of the fields.");
+    cmdLine.set("-nd", 10000, "Number of density values per chunk");
+    cmdLine.set("-ntag", 3, "Number of tag populations");
+    cmdLine.set("-nf", 12, "Number of fisheries");
+    cmdLine.set("-nc", 4, "Number of chunks per rank");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int nd = cmdLine.get<int>("-nd");
+    int ntag = cmdLine.get<int>("-ntag");
+    int nf = cmdLine.get<int>("-nf");
+    int nc = cmdLine.get<int>("-nc");
+    std::size_t numChunks = (std::size_t) nc * size;
+
+    const std::vector<FieldSpec> schema = {
+        {"density", MPI_DOUBLE, (std::size_t) nd},
+        {"tagged_density", MPI_DOUBLE, (std::size_t) nd * ntag},
+        {"catch", MPI_FLOAT, (std::size_t) nf},
+        {"age", MPI_INT, 1},
+    };
+    MultiFieldCollector collector(MPI_COMM_WORLD, numChunks, schema);
+    int iDensity = collector.getFieldIndex("density");
+    int iTagged = collector.getFieldIndex("tagged_density");
+    int iCatch = collector.getFieldIndex("catch");
+    int iAge = collector.getFieldIndex("age");
+    assert(iDensity == 0 && iTagged == 1 && iCatch == 2 && iAge == 3);
+    assert(collector.getFieldIndex("biomass") == -1);
+
+    // the same fields as separate collectors, for comparison
+    DistDataCollector densityCollect(MPI_COMM_WORLD, numChunks, nd);
+    DistDataCollector taggedCollect(MPI_COMM_WORLD, numChunks, (std::size_t) nd * ntag);
+    DistDataCollector catchCollect(MPI_COMM_WORLD, numChunks, nf);
+
+    for (int i = 0; i < nc; ++i) {
+        std::size_t chunkId = (std::size_t) rank * nc + i;
+        std::vector<double> density(nd, double(chunkId));
+        std::vector<double> tagged((std::size_t) nd * ntag, 2.0 * chunkId);
+        std::vector<float> catches(nf, float(3 * chunkId));
+        int age = (int) chunkId % 7;
+        collector.put(chunkId, {density.data(), tagged.data(), catches.data(), &age});
+
+        std::vector<double> catchesD(catches.begin(), catches.end());
+        densityCollect.put(chunkId, density.data());
+        taggedCollect.put(chunkId, tagged.data());
+        catchCollect.put(chunkId, catchesD.data());
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    // fetch density and catch of the chunks of the next rank, skip the tagged densities
+    int source = (rank + 1) % size;
+    std::vector<std::size_t> chunkIds;
+    std::vector<std::vector<double> > densities(nc, std::vector<double>(nd));
+    std::vector<std::vector<float> > catches(nc, std::vector<float>(nf));
+    std::vector<int> ages(nc);
+    std::vector<std::vector<void*> > buffers;
+    for (int i = 0; i < nc; ++i) {
+        chunkIds.push_back((std::size_t) source * nc + i);
+        buffers.push_back({densities[i].data(), nullptr, catches[i].data(), &ages[i]});
+    }
+    collector.get(chunkIds, buffers);
+    for (int i = 0; i < nc; ++i) {
+        for (double v : densities[i]) assert(v == double(chunkIds[i]));
+        for (float v : catches[i]) assert(v == float(3 * chunkIds[i]));
+        assert(ages[i] == (int) chunkIds[i] % 7);
+    }
+
+    // all the fields of all the chunks, one epoch vs one per field and chunk
+    std::vector<double> density(nd), tagged((std::size_t) nd * ntag), catchesD(nf);
+    std::vector<float> catchesF(nf);
+    int age;
+    double tic = MPI_Wtime();
+    for (std::size_t c = 0; c < numChunks; ++c) {
+        densityCollect.get(c, density.data());
+        taggedCollect.get(c, tagged.data());
+        catchCollect.get(c, catchesD.data());
+    }
+    double timeSeparate = MPI_Wtime() - tic;
+    tic = MPI_Wtime();
+    for (std::size_t c = 0; c < numChunks; ++c) {
+        collector.get(c, {density.data(), tagged.data(), catchesF.data(), &age});
+        assert(tagged[0] == 2.0 * c);
+    }
+    double timeMulti = MPI_Wtime() - tic;
+
+    if (rank == 0) {
+        for (std::size_t c = 0; c < numChunks; ++c) {
+            assert(collector.getFieldPtr<double>(c, iDensity)[nd - 1] == double(c));
+            assert(collector.getFieldPtr<double>(c, iTagged)[(std::size_t) nd * ntag - 1] == 2.0 * c);
+            assert(collector.getFieldPtr<float>(c, iCatch)[nf - 1] == float(3 * c));
+            assert(*collector.getFieldPtr<int>(c, iAge) == (int) c % 7);
+        }
+        std::cout << "Chunks: " << numChunks << " fields: " << schema.size()
+                  << " separate collectors: " << timeSeparate << " s multi-field: " << timeMulti << " s\n";
+        std::cout << "Success\n";
+    } else {
+        assert(collector.getFieldPtr<double>(0, iDensity) == nullptr);
+    }
+
+    collector.free();
+    densityCollect.free();
+    taggedCollect.free();
+    catchCollect.free();
+
+    MPI_Finalize();
+    return 0;
+}
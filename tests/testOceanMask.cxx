@@ -0,0 +1,134 @@
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <CmdLineArgParser.h>
+#include "OceanMask.h"
+#include "SeapodymCourier.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Synthetic land mask, a continent in the west and islands elsewhere
+ * @param nbi number of cells along the first dimension
+ * @param nbj number of cells along the second dimension
+ * @return nbi * nbj values, 0 on land
+ */
+std::vector<int> createCarte(int nbi, int nbj) {
+    std::vector<int> carte(nbi * nbj, 1);
+    for (int i = 0; i < nbi; ++i) {
+        for (int j = 0; j < nbj; ++j) {
+            bool continent = i < nbi / 4 + (j % 7);
+            bool island = (i % 11 == 5) && (j % 13 < 3);
+            if (continent || island) carte[i * nbj + j] = 0;
+        }
+    }
+    return carte;
+}
+
+/**
+ * Field value of a cell
+ */
+double inline fieldValue(int rank, int k) {
+    return rank * 1000.0 + k;
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Pack cohort fields to their ocean cells and transfer them compacted.");
+    cmdLine.set("-nbi", 120, "Number of cells along the first dimension");
+    cmdLine.set("-nbj", 80, "Number of cells along the second dimension");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int nbi = cmdLine.get<int>("-nbi");
+    int nbj = cmdLine.get<int>("-nbj");
+
+    std::vector<int> carte = createCarte(nbi, nbj);
+    OceanMask mask(carte, nbi, nbj);
+    std::size_t numCells = mask.getNumCells();
+    std::size_t numOcean = mask.getNumOcean();
+    assert(numOcean > 0 && numOcean < numCells);
+
+    std::vector<double> field(numCells);
+    for (std::size_t k = 0; k < numCells; ++k) field[k] = fieldValue(rank, k);
+
+    // round trip, land cells are reset
+    std::vector<double> ocean = mask.pack(field);
+    std::vector<double> field2 = mask.unpack(ocean, -1.0);
+    for (std::size_t k = 0; k < numCells; ++k) {
+        assert(field2[k] == (carte[k] ? field[k] : -1.0));
+    }
+
+    // fetch the ocean cells of the next rank through the indexed datatype
+    {
+        SeapodymCourier courier(MPI_COMM_WORLD);
+        courier.expose(field.data(), (int) numCells);
+        courier.setOceanMask(&mask);
+        MPI_Barrier(MPI_COMM_WORLD);
+        int source = (rank + 1) % size;
+        std::vector<double> remote = courier.fetchOcean(source);
+        assert(remote.size() == numOcean);
+        const auto& indices = mask.getOceanIndices();
+        for (std::size_t n = 0; n < numOcean; ++n) {
+            assert(remote[n] == fieldValue(source, indices[n]));
+        }
+
+        // the full field fetch and the accumulate also skip the land cells
+        std::vector<double> remoteField = courier.fetch(source);
+        for (std::size_t k = 0; k < numCells; ++k) {
+            assert(remoteField[k] == (carte[k] ? fieldValue(source, k) : 0.0));
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        std::vector<double> sum = courier.accumulate(0);
+        if (rank == 0) {
+            for (std::size_t k = 0; k < numCells; ++k) {
+                double expected = 0;
+                for (int r = 0; r < size; ++r) expected += carte[k] ? fieldValue(r, k) : 0.0;
+                assert(sum[k] == expected);
+            }
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        courier.free();
+    }
+
+    // collect the packed fields, one chunk of ocean cells per rank
+    DistDataCollector collector(MPI_COMM_WORLD, size, numOcean);
+    collector.put(rank, ocean.data());
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) {
+        for (int r = 0; r < size; ++r) {
+            std::vector<double> full(numCells);
+            mask.unpack(collector.getChunkPtr(r), full.data());
+            for (std::size_t k = 0; k < numCells; ++k) {
+                assert(full[k] == (carte[k] ? fieldValue(r, k) : 0.0));
+            }
+        }
+        std::cout << "Ocean cells: " << numOcean << " of " << numCells
+                  << " runs: " << mask.getNumRuns()
+                  << " transfer ratio: " << double(numOcean) / double(numCells) << '\n';
+        std::cout << "Success\n";
+    }
+    collector.free();
+
+    MPI_Finalize();
+    return 0;
+}
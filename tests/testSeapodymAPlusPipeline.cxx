@@ -0,0 +1,193 @@
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <cstdio>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepWorker.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "SeapodymAPlusPipeline.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Return the chunk Id
+ * @param task_id Id of the task (same as cohort Id)
+ * @param step step in the task
+ * @return index
+ */
+int inline getChunkId(int task_id, int step, int numAgeGroups) {
+    int row = task_id + step - numAgeGroups + 1;
+    int col = task_id % numAgeGroups;
+    return row * numAgeGroups + col;
+}
+
+/**
+ * Task, the cohorts leaving the last age class feed the A+ cohort and the new
+ * cohorts read the A+ state
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds sleep # milliseconds at each step
+ */
+void
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm,
+    int milliseconds, int numAgeGroups, int numTimeSteps, int numData,
+    DistDataCollector* dataCollector, SeapodymAPlusPipeline* aPlus,
+    std::map<int, std::set<std::array<int, 2>>>* dependencyMap) {
+
+    std::vector<double> localData(numData, 0.0);
+    std::vector<double> data(numData);
+
+    // initial conditions from the other cohorts
+    for (const auto& [task_id2, step] : (*dependencyMap)[task_id]) {
+        dataCollector->get(getChunkId(task_id2, step, numAgeGroups), data.data());
+        std::transform(data.begin(), data.end(), localData.begin(), localData.begin(), std::plus<double>());
+    }
+    // a cohort born at time t reads the A+ state of time t - 1
+    if (task_id >= numAgeGroups) {
+        aPlus->getState(task_id - numAgeGroups, data.data());
+        std::transform(data.begin(), data.end(), localData.begin(), localData.begin(), std::plus<double>());
+    }
+
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds) );
+        std::fill(localData.begin(), localData.end(), double(task_id));
+        dataCollector->put(getChunkId(task_id, step, numAgeGroups), localData.data());
+
+        // leaving the last age class at time task_id, joins A+ at time task_id + 1
+        if (step == numAgeGroups - 1 && task_id + 1 < numTimeSteps) {
+            aPlus->contribute(task_id + 1, localData.data());
+        }
+
+        int output[3] = {task_id, step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    // threads are needed to run the A+ cohort next to the manager
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Run the A+ cohort as a pipeline fed one-sided by the cohorts leaving the last age class.");
+    cmdLine.set("-na", 5, "Number of age groups");
+    cmdLine.set("-nt", 10, "Total number of time steps");
+    cmdLine.set("-nm", 10, "Sleep milliseconds per step");
+    cmdLine.set("-nd", 1000, "Number of data values per cohort");
+    cmdLine.set("-thread", false, "Run the A+ cohort on a thread of the manager rank rather than on the last rank");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int numData = cmdLine.get<int>("-nd");
+    bool useThread = cmdLine.get<bool>("-thread");
+    if (useThread && provided < MPI_THREAD_MULTIPLE) {
+        if (rank == 0) std::cout << "MPI_THREAD_MULTIPLE is not supported, using the last rank\n";
+        useThread = false;
+    }
+
+    // the A+ cohort is owned by rank 0 (thread) or by the last rank, which is then
+    // not part of the task farm
+    int aPlusRank = useThread ? 0 : size - 1;
+    MPI_Comm farmComm;
+    MPI_Comm_split(MPI_COMM_WORLD, (rank == aPlusRank && !useThread) ? 1 : 0, rank, &farmComm);
+
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps);
+    std::map<int, int> stepBegMap = taskDeps.getStepBegMap();
+    std::map<int, int> stepEndMap = taskDeps.getStepEndMap();
+    std::map<int, std::set<std::array<int, 2>>> dependencyMap = taskDeps.getDependencyMap();
+
+    SeapodymAPlusPipeline aPlus(MPI_COMM_WORLD, numTimeSteps, numData, aPlusRank);
+    DistDataCollector dataCollect(MPI_COMM_WORLD, numAgeGroups * numTimeSteps, numData);
+
+    // A+ step: add the cohort that joined, then pretend to compute
+    auto aPlusStep = [&](int, std::vector<double>& state, const double* contribution) {
+        std::transform(state.begin(), state.end(), contribution, state.begin(), std::plus<double>());
+        std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds) );
+    };
+
+    if (rank == aPlusRank && !useThread) {
+
+        aPlus.run(aPlusStep);
+
+    } else {
+
+        auto taskFunc = std::bind(taskFunction,
+            std::placeholders::_1, // task_id
+            std::placeholders::_2, // stepBeg
+            std::placeholders::_3, // stepEnd
+            std::placeholders::_4, // comm
+            milliseconds,
+            numAgeGroups,
+            numTimeSteps,
+            numData,
+            &dataCollect,
+            &aPlus,
+            &dependencyMap);
+
+        int farmRank;
+        MPI_Comm_rank(farmComm, &farmRank);
+        if (farmRank == 0) {
+            std::thread aPlusThread;
+            if (useThread) aPlusThread = std::thread([&]() { aPlus.run(aPlusStep); });
+
+            TaskStepManager manager(farmComm, taskDeps.getNumberOfCohorts(), stepBegMap, stepEndMap, dependencyMap);
+            double tic = MPI_Wtime();
+            const auto results = manager.run();
+            double toc = MPI_Wtime();
+            if (useThread) aPlusThread.join();
+
+            assert(results.size() == (std::size_t) taskDeps.getNumberOfCohortSteps());
+            std::cout << "A+ on " << (useThread ? "thread" : "rank") << " Execution time: " << toc - tic << '\n';
+        } else {
+            TaskStepWorker worker(farmComm, taskFunc, stepBegMap, stepEndMap);
+            worker.run();
+        }
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) {
+        // sum of the feeders 0 .. nt - 2
+        std::vector<double> state(numData);
+        aPlus.getState(numTimeSteps - 1, state.data());
+        double aPlusChecksum = std::accumulate(state.begin(), state.end(), 0.0);
+        const double* data = dataCollect.getCollectedDataPtr();
+        double checksum = std::accumulate(data, data + (std::size_t) numAgeGroups * numTimeSteps * numData, 0.0);
+        printf("checksum: %.0lf A+ checksum: %.0lf\n", checksum, aPlusChecksum);
+        std::cout << "Success\n";
+    }
+
+    dataCollect.free();
+    aPlus.free();
+    MPI_Comm_free(&farmComm);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -28,9 +28,11 @@ int main(int argc, char** argv) {
     std::map<int, std::set<std::array<int,2>>> dependencyMap = depAnalyzer.getDependencyMap();
     std::map<int, int> stepBegMap = depAnalyzer.getStepBegMap();
     std::map<int, int> stepEndMap = depAnalyzer.getStepEndMap();
+    std::map<int, std::array<int, 2>> timeRangeMap = depAnalyzer.getTimeRangeMap();
 
     for (auto id = 0; id < numCohorts; ++id) {
-        std::cout << "Cohort " << id << " has steps " << stepBegMap.at(id) << "... " << stepEndMap.at(id) - 1 << " and depends on: ";
+        std::cout << "Cohort " << id << " has steps " << stepBegMap.at(id) << "... " << stepEndMap.at(id) - 1
+                  << " at times " << timeRangeMap.at(id)[0] << "... " << timeRangeMap.at(id)[1] - 1 << " and depends on: ";
         auto depSet = dependencyMap.at(id);
         for (const auto& [id2, step] : depSet) {
             std::cout << "(" << id2 << ", " << step << ") ";
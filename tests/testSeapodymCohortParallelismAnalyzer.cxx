@@ -0,0 +1,71 @@
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "SeapodymCohortParallelismAnalyzer.h"
+#include "CmdLineArgParser.h"
+#include <iostream>
+#undef NDEBUG
+#include <cassert>
+
+int main(int argc, char** argv) {
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Report the critical path, available parallelism and speedup bounds of a cohort DAG.");
+    cmdLine.set("-na", 3, "Number of age groups");
+    cmdLine.set("-nt", 5, "Total number of time steps");
+    cmdLine.set("-age_mature", 0, "Index of the first mature age class");
+    cmdLine.set("-aplus", false, "Add the A+ cohorts");
+    cmdLine.set("-nw", 16, "Largest number of workers to report the speedup bound for");
+    cmdLine.set("-csv", std::string(""), "Write the speedup bounds to this CSV file");
+    cmdLine.set("-profile", std::string(""), "Write the parallelism profile to this CSV file");
+    cmdLine.addFootnote("The speedup CSV has columns numWorkers,speedupBound,parallelEffBound.");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int ageMature = cmdLine.get<int>("-age_mature");
+    bool aPlus = cmdLine.get<bool>("-aplus");
+    int maxNumWorkers = cmdLine.get<int>("-nw");
+    std::string csvFile = cmdLine.get<std::string>("-csv");
+    std::string profileFile = cmdLine.get<std::string>("-profile");
+
+    SeapodymCohortDependencyAnalyzer depAnalyzer(numAgeGroups, numTimeSteps, ageMature, aPlus);
+    SeapodymCohortParallelismAnalyzer parAnalyzer(depAnalyzer);
+
+    int work = parAnalyzer.getTotalWork();
+    int criticalPath = parAnalyzer.getCriticalPathLength();
+
+    std::cout << "na=" << numAgeGroups << " nt=" << numTimeSteps
+              << " age_mature=" << ageMature << " aplus=" << aPlus << '\n';
+    std::cout << "Total work (steps): " << work << '\n';
+    std::cout << "Critical path (steps): " << criticalPath << '\n';
+    std::cout << "Average parallelism: " << parAnalyzer.getAverageParallelism() << '\n';
+    std::cout << "Peak parallelism: " << parAnalyzer.getPeakParallelism() << '\n';
+    for (int nw = 1; nw <= maxNumWorkers; ++nw) {
+        double speedup = parAnalyzer.getSpeedupBound(nw);
+        std::cout << "  workers: " << nw << " speedup bound: " << speedup
+                  << " parallel eff bound: " << speedup / double(nw) << '\n';
+    }
+
+    if (!csvFile.empty()) parAnalyzer.writeSpeedupCsv(csvFile, maxNumWorkers);
+    if (!profileFile.empty()) parAnalyzer.writeProfileCsv(profileFile);
+
+    // consistency checks
+    assert(work == depAnalyzer.getNumberOfCohortSteps());
+    int sum = 0;
+    for (int n : parAnalyzer.getParallelismProfile()) sum += n;
+    assert(sum == work);
+    assert(parAnalyzer.getSpeedupBound(1) == 1.0);
+
+    std::cout << "Success\n";
+    return 0;
+}
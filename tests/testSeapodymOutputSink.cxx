@@ -0,0 +1,210 @@
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepWorker.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "SeapodymOutputSink.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Return the chunk Id
+ * @param task_id Id of the task (same as cohort Id)
+ * @param step step in the task
+ * @param numSlots number of time steps held by the collector, 0 for all
+ * @return index
+ */
+std::size_t inline getChunkId(int task_id, int step, int numAgeGroups, int numSlots) {
+    int row = task_id + step - numAgeGroups + 1;
+    if (numSlots > 0) row %= numSlots;
+    int col = task_id % numAgeGroups;
+    return (std::size_t) row * numAgeGroups + col;
+}
+
+/**
+ * Density of a cohort at a cell, differs along i and j to check the transposition
+ */
+double inline density(int task_id, int i, int j) {
+    return task_id + i + 100.0 * j;
+}
+
+/**
+ * Task
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds sleep # milliseconds at each step
+ * @param birthFactor sleep factor of the first step of the odd newborn cohorts
+ */
+void
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm, int milliseconds, int birthFactor,
+             int numAgeGroups, int numSlots, int nbi, int nbj, DistDataCollector* dataCollector) {
+    std::vector<double> field((std::size_t) nbi * nbj);
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        int factor = (step == 0 && task_id % 2 == 1) ? birthFactor : 1;
+        std::this_thread::sleep_for( std::chrono::milliseconds(factor * milliseconds) );
+        for (int i = 0; i < nbi; ++i) {
+            for (int j = 0; j < nbj; ++j) field[i * nbj + j] = density(task_id, i, j);
+        }
+        dataCollector->put(getChunkId(task_id, step, numAgeGroups, numSlots), field.data());
+        int output[3] = {task_id, step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Stream the age-structured cohort fields to DYM files while the steps complete.");
+    cmdLine.set("-na", 6, "Number of age groups");
+    cmdLine.set("-nt", 10, "Total number of time steps");
+    cmdLine.set("-nm", 5, "Sleep milliseconds per step");
+    cmdLine.set("-nbi", 40, "Number of cells along longitude");
+    cmdLine.set("-nbj", 30, "Number of cells along latitude");
+    cmdLine.set("-buffer", 65536, "Write-behind buffer size per file in bytes");
+    cmdLine.set("-slots", 0, "Number of time steps held by the collector, 0 for all");
+    cmdLine.set("-am", 0, "First mature age group, the newborn cohorts only depend on the mature ones");
+    cmdLine.set("-nb", 1, "Sleep factor of the birth step of the odd cohorts");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int nbi = cmdLine.get<int>("-nbi");
+    int nbj = cmdLine.get<int>("-nbj");
+    int bufferBytes = cmdLine.get<int>("-buffer");
+    int numSlots = cmdLine.get<int>("-slots");
+    int ageMature = cmdLine.get<int>("-am");
+    int birthFactor = cmdLine.get<int>("-nb");
+    assert(numAgeGroups >= 3);
+
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps, ageMature);
+    DistDataCollector dataCollect(MPI_COMM_WORLD, numAgeGroups * (numSlots > 0 ? numSlots : numTimeSteps), nbi * nbj);
+
+    auto taskFunc = std::bind(taskFunction,
+        std::placeholders::_1, // task_id
+        std::placeholders::_2, // stepBeg
+        std::placeholders::_3, // stepEnd
+        std::placeholders::_4, // comm
+        milliseconds, birthFactor, numAgeGroups, numSlots, nbi, nbj, &dataCollect);
+
+    // age classes of the output
+    const std::vector<std::string> names = {"juvenile", "young", "adult", "total_pop"};
+    const std::vector<std::array<int, 2> > ageRanges = {{0, 1}, {1, 2}, {2, numAgeGroups}, {0, numAgeGroups}};
+
+    if (workerId == 0) {
+
+        SeapodymOutputSink sink(dataCollect,
+            [numAgeGroups, numSlots](int task_id, int step) { return getChunkId(task_id, step, numAgeGroups, numSlots); },
+            numAgeGroups, numTimeSteps, nbi, nbj);
+        sink.setNumSlots(numSlots);
+        for (std::size_t v = 0; v < names.size(); ++v) {
+            sink.addVariable(names[v], ageRanges[v][0], ageRanges[v][1], "testOutputSink_" + names[v] + ".dym");
+        }
+        sink.setDates(2000.0, 1.0/12.0);
+        sink.setBufferSize(bufferBytes);
+        sink.start();
+
+        TaskStepManager manager(MPI_COMM_WORLD, taskDeps.getNumberOfCohorts(),
+            taskDeps.getStepBegMap(), taskDeps.getStepEndMap(), taskDeps.getDependencyMap());
+        manager.setStepListener([&](int task_id, int step, int) {
+            // the slot of the step was not reused before the sink wrote it
+            assert(numSlots == 0 || task_id + step - numAgeGroups + 1 < sink.getNumWritten() + numSlots);
+            sink.notify(task_id, step);
+        });
+        manager.setDispatchGate([&sink](int task_id) { return sink.canDispatch(task_id); });
+
+        double tic = MPI_Wtime();
+        const auto results = manager.run();
+        double toc = MPI_Wtime();
+        int numWrittenAtEnd = sink.getNumWritten();
+        sink.finish();
+        double tac = MPI_Wtime();
+        assert(results.size() == (std::size_t) taskDeps.getNumberOfCohortSteps());
+        assert(sink.getNumWritten() == numTimeSteps);
+
+        // check the records
+        for (std::size_t v = 0; v < names.size(); ++v) {
+            std::string filename = "testOutputSink_" + names[v] + ".dym";
+            for (int t = 0; t < numTimeSteps; ++t) {
+                int nlon, nlat;
+                std::vector<float> record = SeapodymOutputSink::readDymRecord(filename, t, nlon, nlat);
+                assert(nlon == nbi && nlat == nbj);
+                for (int i = 0; i < nbi; ++i) {
+                    for (int j = 0; j < nbj; ++j) {
+                        double expected = 0;
+                        for (int age = ageRanges[v][0]; age < ageRanges[v][1]; ++age) {
+                            expected += density(t + numAgeGroups - 1 - age, i, j);
+                        }
+                        assert(record[j * nbi + i] == float(expected));
+                    }
+                }
+            }
+            std::remove(filename.c_str());
+        }
+
+        {
+            // without time steps, finish returns at once
+            SeapodymOutputSink emptySink(dataCollect,
+                [numAgeGroups](int task_id, int step) { return getChunkId(task_id, step, numAgeGroups, 0); },
+                numAgeGroups, 0, nbi, nbj);
+            emptySink.addVariable("empty", 0, numAgeGroups, "testOutputSink_empty.dym");
+            emptySink.start();
+            emptySink.finish();
+            assert(emptySink.getNumWritten() == 0);
+            std::remove("testOutputSink_empty.dym");
+        }
+
+        {
+            // a cohort must fit in the window
+            bool thrown = false;
+            try {
+                sink.setNumSlots(numAgeGroups - 1);
+            } catch (const std::invalid_argument&) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+        std::cout << "Run time: " << toc - tic << " written during the run: " << numWrittenAtEnd
+                  << "/" << numTimeSteps << " write time: " << sink.getWriteTime()
+                  << " finish time: " << tac - toc << '\n';
+        std::cout << "Success\n";
+
+    } else {
+        TaskStepWorker worker(MPI_COMM_WORLD, taskFunc, taskDeps.getStepBegMap(), taskDeps.getStepEndMap());
+        worker.run();
+    }
+
+    dataCollect.free();
+
+    MPI_Finalize();
+    return 0;
+}
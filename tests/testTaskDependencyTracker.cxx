@@ -0,0 +1,120 @@
+#include <mpi.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <CmdLineArgParser.h>
+#include "TaskDependencyTracker.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Build a cohort like graph, task i depends on i - 1 and i - width
+ * @param numTasks number of tasks
+ * @param width distance of the second dependency
+ * @return task Id -> dependencies
+ */
+std::map<int, std::set<int> >
+buildGraph(int numTasks, int width) {
+    std::map<int, std::set<int> > deps;
+    for (int i = 0; i < numTasks; ++i) {
+        std::set<int> d;
+        if (i >= 1) d.insert(i - 1);
+        if (i >= width) d.insert(i - width);
+        deps[i] = d;
+    }
+    return deps;
+}
+
+/**
+ * Execute the graph serially with the tracker
+ * @param deps task Id -> dependencies
+ * @return number of executed tasks
+ */
+std::size_t
+runTracker(const std::map<int, std::set<int> >& deps) {
+    TaskDependencyTracker tracker(deps);
+    while (tracker.hasReady()) tracker.complete(tracker.popReady());
+    return tracker.getNumCompleted();
+}
+
+/**
+ * Execute the graph serially by scanning all the tasks after each completion, as
+ * TaskDependencyManager used to
+ * @param deps task Id -> dependencies
+ * @return number of executed tasks
+ */
+std::size_t
+runScan(const std::map<int, std::set<int> >& deps) {
+    std::set<int> completed, assigned;
+    while (true) {
+        int next = -1;
+        for (const auto& [taskId, d] : deps) {
+            if (assigned.count(taskId)) continue;
+            bool ready = true;
+            for (int dep : d) ready = ready && completed.count(dep) > 0;
+            if (ready) {
+                next = taskId;
+                break;
+            }
+        }
+        if (next < 0) break;
+        assigned.insert(next);
+        completed.insert(next);
+    }
+    return completed.size();
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Measure the cost of tracking the ready tasks for 1k up to nmax tasks.");
+    cmdLine.set("-nmax", 1000000, "Largest number of tasks");
+    cmdLine.set("-nscan", 10000, "Largest number of tasks for the full scan");
+    cmdLine.set("-width", 5, "Distance of the second dependency (number of age groups)");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int nmax = cmdLine.get<int>("-nmax");
+    int nscan = cmdLine.get<int>("-nscan");
+    int width = cmdLine.get<int>("-width");
+
+    for (int numTasks = 1000; numTasks <= nmax; numTasks *= 10) {
+        const auto deps = buildGraph(numTasks, width);
+
+        double tic = MPI_Wtime();
+        std::size_t n = runTracker(deps);
+        double toc = MPI_Wtime();
+        assert(n == (std::size_t) numTasks);
+        std::cout << "Tasks: " << numTasks << " tracker: " << toc - tic << " s ("
+                  << 1.e9 * (toc - tic) / numTasks << " ns/task)";
+
+        if (numTasks <= nscan) {
+            tic = MPI_Wtime();
+            n = runScan(deps);
+            toc = MPI_Wtime();
+            assert(n == (std::size_t) numTasks);
+            std::cout << " scan: " << toc - tic << " s";
+        }
+        std::cout << '\n';
+    }
+
+    std::cout << "Success\n";
+
+    MPI_Finalize();
+    return 0;
+}
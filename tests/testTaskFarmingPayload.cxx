@@ -0,0 +1,105 @@
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <CmdLineArgParser.h>
+#include "TaskManager.h"
+#include "TaskWorker.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Task returning a payload
+ * @param task_id index 0.. numTasks - 1
+ * @param numData number of values, 0 for a size varying with the task
+ * @return task_id, task_id + 1, ...
+ */
+std::vector<double> taskFunc2(int task_id, int numData) {
+    int n = (numData > 0) ? numData : 1 + task_id % 7;
+    std::vector<double> payload(n);
+    for (int i = 0; i < n; ++i) payload[i] = task_id + i;
+    return payload;
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Return variable length payloads from the tasks of a TaskManager.");
+    cmdLine.set("-nT", 1000, "Total number of tasks");
+    cmdLine.set("-chunk", 1, "Minimum number of tasks per range (guided)");
+    cmdLine.set("-collect", false, "Put the payloads into a DistDataCollector");
+    cmdLine.set("-nd", 4, "Payload size with -collect");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numTasks = cmdLine.get<int>("-nT");
+    int chunk = cmdLine.get<int>("-chunk");
+    bool collect = cmdLine.get<bool>("-collect");
+    int numData = collect ? cmdLine.get<int>("-nd") : 0;
+
+    // one chunk per task
+    DistDataCollector dataCollect(MPI_COMM_WORLD, collect ? numTasks : 1, collect ? numData : 1);
+
+    if (workerId == 0) {
+
+        TaskManager manager(MPI_COMM_WORLD, numTasks);
+        manager.setChunking(TaskManager::CHUNK_GUIDED, chunk);
+
+        std::vector<int> numReceived(numTasks, 0);
+        double checksum = 0;
+        manager.run([&](int taskId, const double* data, int n) {
+            numReceived[taskId]++;
+            if (collect) {
+                assert(data == nullptr);
+                return;
+            }
+            assert(n == 1 + taskId % 7);
+            for (int i = 0; i < n; ++i) {
+                assert(data[i] == taskId + i);
+                checksum += data[i];
+            }
+        });
+
+        for (int taskId = 0; taskId < numTasks; ++taskId) assert(numReceived[taskId] == 1);
+        if (collect) {
+            const double* data = dataCollect.getCollectedDataPtr();
+            for (int taskId = 0; taskId < numTasks; ++taskId) {
+                for (int i = 0; i < numData; ++i) {
+                    assert(data[taskId * numData + i] == taskId + i);
+                    checksum += data[taskId * numData + i];
+                }
+            }
+        }
+        std::cout << "Tasks: " << numTasks << " Collect: " << collect << " checksum: " << checksum << '\n';
+        std::cout << "Success\n";
+
+    } else {
+
+        auto taskFunc = [numData](int task_id) { return taskFunc2(task_id, numData); };
+        TaskWorker worker(MPI_COMM_WORLD, taskFunc, collect ? &dataCollect : nullptr);
+        worker.run();
+
+    }
+
+    dataCollect.free();
+
+    MPI_Finalize();
+    return 0;
+}
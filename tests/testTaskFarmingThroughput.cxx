@@ -0,0 +1,93 @@
+#include <mpi.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <CmdLineArgParser.h>
+#include "TaskManager.h"
+#include "TaskWorker.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Task, busy waits
+ * @param task_id index 0.. numTasks - 1
+ * @param microseconds duration of the task
+ * @return result
+ */
+int taskFunc2(int task_id, double microseconds) {
+    double tic = MPI_Wtime();
+    while (1.e6 * (MPI_Wtime() - tic) < microseconds) {}
+    return task_id;
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Measure the TaskManager throughput against the task duration for the chunk policies.");
+    cmdLine.set("-nT", 10000, "Total number of tasks");
+    cmdLine.set("-usmax", 100, "Longest task duration in microseconds (durations 0, 1, 10, ... usmax)");
+    cmdLine.set("-chunk", 16, "Number of tasks per range of the fixed policy");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numTasks = cmdLine.get<int>("-nT");
+    int usmax = cmdLine.get<int>("-usmax");
+    int chunk = cmdLine.get<int>("-chunk");
+
+    // policy name -> (policy, chunk size)
+    const std::map<std::string, std::pair<TaskManager::ChunkPolicy, int> > policies = {
+        {"single", {TaskManager::CHUNK_FIXED, 1}},
+        {"fixed", {TaskManager::CHUNK_FIXED, chunk}},
+        {"guided", {TaskManager::CHUNK_GUIDED, 1}},
+    };
+
+    if (workerId == 0) std::cout << "Workers: " << size - 1 << " Tasks: " << numTasks << '\n';
+
+    for (int us = 0; us <= usmax; us = (us == 0) ? 1 : 10 * us) {
+
+        auto taskFunc = [us](int task_id) { return taskFunc2(task_id, us); };
+
+        for (const auto& [name, policy] : policies) {
+
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            if (workerId == 0) {
+                TaskManager manager(MPI_COMM_WORLD, numTasks);
+                manager.setChunking(policy.first, policy.second);
+                double tic = MPI_Wtime();
+                std::map<int, int> results = manager.run();
+                double toc = MPI_Wtime();
+
+                assert(results.size() == (std::size_t) numTasks);
+                for (auto [taskId, res] : results) assert(taskId == res);
+                std::cout << "Task duration: " << us << " us Policy: " << name
+                          << " Tasks per second: " << numTasks / (toc - tic) << '\n';
+            } else {
+                TaskWorker worker(MPI_COMM_WORLD, taskFunc);
+                worker.run();
+            }
+        }
+    }
+
+    if (workerId == 0) std::cout << "Success\n";
+
+    MPI_Finalize();
+    return 0;
+}
@@ -12,6 +12,8 @@
 #include "TaskStepWorker.h"
 #include "SeapodymCohortDependencyAnalyzer.h"
 #include "DistDataCollector.h"
+#include "TaskStepPublisher.h"
+#include "Trace.h"
 #undef NDEBUG
 #include <cassert>
 
@@ -41,7 +43,8 @@ taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm,
     int init_milliseconds, int numAgeGroups, int numData,
     DistDataCollector* dataCollector, // need to be a pointer, or else provide a copy constructor
     std::map<int, std::set<std::array<int, 2>>>* dependencyMap,
-    std::mt19937* rng, std::gamma_distribution<double>* dist) {
+    std::mt19937* rng, std::gamma_distribution<double>* dist,
+    TaskStepPublisher* publisher) {
 
     std::vector<double> localData(numData);
     std::vector<double> data(numData);
@@ -68,43 +71,59 @@ taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm,
     }
     
     // pretend to initialise
-    std::this_thread::sleep_for( std::chrono::milliseconds(init_milliseconds) );
+    {
+        SEAPODYM_TRACE_SCOPE(TRACE_TASK_INIT, task_id, stepBeg);
+        std::this_thread::sleep_for( std::chrono::milliseconds(init_milliseconds) );
+    }
 
     // step through...
     for (auto step = stepBeg; step < stepEnd; ++step) {
 
-        // Perform the work, just sleeping here zzzzzzz
-        int tsleep = static_cast<int>( std::round( (*dist)(*rng) ) );
-        std::this_thread::sleep_for( std::chrono::milliseconds(tsleep) );
+        {
+            SEAPODYM_TRACE_SCOPE(TRACE_STEP_COMPUTE, task_id, step);
+
+            // Perform the work, just sleeping here zzzzzzz
+            int tsleep = static_cast<int>( std::round( (*dist)(*rng) ) );
+            std::this_thread::sleep_for( std::chrono::milliseconds(tsleep) );
 
-        // Pretend we are computing some data
-        std::fill(localData.begin(), localData.end(), double(task_id));
+            // Pretend we are computing some data
+            std::fill(localData.begin(), localData.end(), double(task_id));
+        }
         
         // Send the data to the manager. Here, the data are 
         // collected row by row. The entry into the collected 
         // array is at index chunk_id.
         int chunk_id = getChunkId(task_id, step, numAgeGroups);
-        dataCollector->put(chunk_id, localData.data());
 
         // E.g.
         int success = task_id;
 
+        if (publisher) {
+            // put the data and mark the step as complete, no message
+            publisher->publishStep(*dataCollector, chunk_id, localData.data(), task_id, step, success);
+            continue;
+        }
+        dataCollector->put(chunk_id, localData.data());
+
         // Notify the manager at the end of each step
         int output[3] = {task_id, step, success};
         const int endTaskTag = 1;
+        SEAPODYM_TRACE_SCOPE(TRACE_END_TASK_SEND, task_id, step, 0);
         MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
     }
 }
 
 int main(int argc, char** argv) {
 
-    // MPI initialization
-    MPI_Init(&argc, &argv);
+    // MPI initialization, threads are needed to colocate the manager and a worker
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
     int numWorkers, size;
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     numWorkers = size - 1;
     int workerId;
     MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    SEAPODYM_TRACE_INIT(MPI_COMM_WORLD);
     
     // Parse the command line arguments
     CmdLineArgParser cmdLine;
@@ -116,6 +135,12 @@ int main(int argc, char** argv) {
     cmdLine.set("-seed", 123456789, "Random seed");
     cmdLine.set("-nd", 10000, "Number of data values to send from worker to manager at each step");
     cmdLine.set("-age_mature", 0, "index of the first mature age class");
+    cmdLine.set("-profile_in", std::string(""), "Order the tasks using the step costs of a previous run (CSV)");
+    cmdLine.set("-profile_out", std::string(""), "Save the measured step costs to this CSV file");
+    cmdLine.set("-depth", 0, "Number of persistent receives per worker on the manager (0: probe)");
+    cmdLine.set("-publish", false, "Notify the step completions through an RMA completion board instead of messages");
+    cmdLine.set("-colocate", false, "Run the manager on a thread of rank 0, which also acts as a worker");
+    cmdLine.set("-early", false, "Initialize the cohorts on free workers before their dependencies complete");
     bool success = cmdLine.parse(argc, argv);
     bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
     if (!success) {
@@ -138,6 +163,16 @@ int main(int argc, char** argv) {
     int seed = cmdLine.get<int>("-seed") + workerId;
     double sd = cmdLine.get<double>("-sd");
     int ageMature = cmdLine.get<int>("-age_mature");
+    std::string profileIn = cmdLine.get<std::string>("-profile_in");
+    std::string profileOut = cmdLine.get<std::string>("-profile_out");
+    bool colocate = cmdLine.get<bool>("-colocate");
+    bool publish = cmdLine.get<bool>("-publish");
+    bool early = cmdLine.get<bool>("-early");
+    if (colocate && provided < MPI_THREAD_MULTIPLE) {
+        if (workerId == 0) std::cout << "MPI_THREAD_MULTIPLE is not supported, not colocating\n";
+        colocate = false;
+    }
+    if (colocate) numWorkers = size;
 
     std::mt19937 rng;              // Could also seed with std::random_device
     rng.seed(seed);
@@ -169,22 +204,31 @@ int main(int argc, char** argv) {
     int numChunks = numAgeGroups * numTimeSteps;
     DistDataCollector dataCollect(MPI_COMM_WORLD, numChunks, numData);
 
+    // completion board, collective
+    TaskStepPublisher publisher(MPI_COMM_WORLD, stepBegMap, stepEndMap);
+
     auto taskFunc = std::bind(taskFunction,
         std::placeholders::_1, // task_id
         std::placeholders::_2, // stepBeg
         std::placeholders::_3, // stepEnd
         std::placeholders::_4, // comm
-        init_milliseconds,
+        early ? 0 : init_milliseconds, // with -early the initialization is done by initFunc
         numAgeGroups,
         numData,
         &dataCollect,
         &dependencyMap,
         &rng,
-        &dist);
+        &dist,
+        publish ? &publisher : nullptr);
 
-    
+    // pretend to initialise, independently of the other cohorts
+    auto initFunc = [&](int, MPI_Comm) {
+        std::this_thread::sleep_for( std::chrono::milliseconds(init_milliseconds) );
+    };
 
-    TaskStepWorker worker(MPI_COMM_WORLD, taskFunc, stepBegMap, stepEndMap);
+    TaskStepWorker worker = early ?
+        TaskStepWorker(MPI_COMM_WORLD, initFunc, taskFunc, stepBegMap, stepEndMap) :
+        TaskStepWorker(MPI_COMM_WORLD, taskFunc, stepBegMap, stepEndMap);
     // sync the manager and workers
     MPI_Barrier(MPI_COMM_WORLD);
 
@@ -194,11 +238,30 @@ int main(int argc, char** argv) {
         
         // note: the number of tasks is the number of cohorts
         TaskStepManager manager(MPI_COMM_WORLD, numCohorts, stepBegMap, stepEndMap, dependencyMap);
+        if (!profileIn.empty()) {
+            TaskStepProfile profile;
+            if (profile.load(profileIn)) {
+                std::cout << "Using the step costs of " << profileIn << std::endl;
+                manager.setProfile(profile);
+            }
+        }
+
+        manager.setCompletionDepth(cmdLine.get<int>("-depth"));
+        manager.setEarlyInit(early);
+        if (publish) manager.setPublisher(&publisher);
 
         double tic = MPI_Wtime();
 
         // container stores the results TaskId, step, result
-        const auto results = manager.run();
+        std::set< std::array<int, 3> > results;
+        if (colocate) {
+            manager.setColocatedWorker(true);
+            std::thread managerThread([&]() { results = manager.run(); });
+            worker.run();
+            managerThread.join();
+        } else {
+            results = manager.run();
+        }
 
         double toc = MPI_Wtime();
 
@@ -209,6 +272,8 @@ int main(int argc, char** argv) {
             " Ideal: " << numWorkers << 
             " Parallel eff: " << speedup/double(numWorkers) << std::endl;
 
+        if (!profileOut.empty()) manager.getMeasuredProfile().save(profileOut);
+
 
         // make sure there are no duplicate tasks and all the tasks have been executed
         assert(numTotalSteps == numCohortSteps);
@@ -230,18 +295,21 @@ int main(int argc, char** argv) {
     //MPI_Barrier(MPI_COMM_WORLD);
 
     if (workerId == 0) {
-        double* data = dataCollect.getCollectedDataPtr();
-        int numSize = dataCollect.getNumSize();
+        std::size_t numSize = dataCollect.getNumSize();
         double checksum = 0;
-        for (auto chunk = 0; chunk < dataCollect.getNumChunks(); ++chunk) {\
-            for (auto i = 0; i < numSize; ++i) {
-                checksum += data[chunk*numSize + i];
+        for (std::size_t chunk = 0; chunk < dataCollect.getNumChunks(); ++chunk) {
+            const double* data = dataCollect.getChunkPtr(chunk);
+            for (std::size_t i = 0; i < numSize; ++i) {
+                checksum += data[i];
             }
         }
         printf("\nchecksum: %.0lf\n", checksum);
     }
 
+    publisher.free();
     dataCollect.free();
+
+    SEAPODYM_TRACE_FLUSH("trace");
     
     // Clean up
     MPI_Finalize();
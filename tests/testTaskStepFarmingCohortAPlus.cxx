@@ -260,8 +260,7 @@ int main(int argc, char** argv) {
     //MPI_Barrier(MPI_COMM_WORLD);
 
     if (workerId == 0) {
-        double* data = dataCollect.getCollectedDataPtr();
-        int numSize = dataCollect.getNumSize();
+        std::size_t numSize = dataCollect.getNumSize();
 
         // Normal-cohort checksum (matches testTaskStepFarmingCohortAPlus3 dataCollect checksum).
         // Expected for na=5, nt=10, nd=100000: 32500000
@@ -271,7 +270,8 @@ int main(int argc, char** argv) {
             int stepEnd = stepEndMap.at(task_id);
             for (auto step = stepBeg; step < stepEnd; ++step) {
                 int chunk_id = getChunkId(task_id, step, numAgeGroups, numTimeSteps, firstAPlusId);
-                normalChecksum += std::accumulate(&data[chunk_id*numSize], &data[(chunk_id + 1)*numSize], 0.0);
+                const double* data = dataCollect.getChunkPtr(chunk_id);
+                normalChecksum += std::accumulate(data, data + numSize, 0.0);
             }
         }
         printf("\ndataCollect checksum: %.0lf\n", normalChecksum);
@@ -280,9 +280,8 @@ int main(int argc, char** argv) {
         // after all feeder cohorts (0..nt-2) have contributed.
         // Expected for na=5, nt=10, nd=100000: sum(0..8)*100000 = 36*100000 = 3600000
         int lastAPlusChunkId = getChunkId(firstAPlusId + numTimeSteps - 1, 0, numAgeGroups, numTimeSteps, firstAPlusId);
-        double aplusAccumChecksum = std::accumulate(
-            &data[lastAPlusChunkId * numSize],
-            &data[(lastAPlusChunkId + 1) * numSize], 0.0);
+        const double* aplusData = dataCollect.getChunkPtr(lastAPlusChunkId);
+        double aplusAccumChecksum = std::accumulate(aplusData, aplusData + numSize, 0.0);
         printf("aplusCollect accumulator (chunk 1) checksum: %.0lf\n", aplusAccumChecksum);
     }
 
@@ -315,12 +315,12 @@ int main(int argc, char** argv) {
         // Checksum of the main data collector (rank 0 only).
         // Expected for na=5, nt=10, nd=100000: 32500000
         if (rank == 0) {
-            double* data    = dataCollect.getCollectedDataPtr();
-            int     numSize = dataCollect.getNumSize();
+            std::size_t numSize = dataCollect.getNumSize();
             double  checksum = 0.0;
-            for (int chunk = 0; chunk < dataCollect.getNumChunks(); ++chunk)
-                checksum += std::accumulate(&data[chunk * numSize],
-                                            &data[(chunk + 1) * numSize], 0.0);
+            for (std::size_t chunk = 0; chunk < dataCollect.getNumChunks(); ++chunk) {
+                const double* data = dataCollect.getChunkPtr(chunk);
+                checksum += std::accumulate(data, data + numSize, 0.0);
+            }
             printf("\ndataCollect checksum: %.0lf\n", checksum);
         }
 
@@ -305,12 +305,12 @@ int main(int argc, char** argv) {
         // Normal cohort checksum.
         // Expected for na=5, nt=10, nd=100000: 32500000
         {
-            double* data    = dataCollect.getCollectedDataPtr();
-            int     numSize = dataCollect.getNumSize();
+            std::size_t numSize = dataCollect.getNumSize();
             double  checksum = 0.0;
-            for (int chunk = 0; chunk < dataCollect.getNumChunks(); ++chunk)
-                checksum += std::accumulate(&data[chunk * numSize],
-                                            &data[(chunk + 1) * numSize], 0.0);
+            for (std::size_t chunk = 0; chunk < dataCollect.getNumChunks(); ++chunk) {
+                const double* data = dataCollect.getChunkPtr(chunk);
+                checksum += std::accumulate(data, data + numSize, 0.0);
+            }
             printf("\ndataCollect checksum: %.0lf\n", checksum);
         }
 
@@ -320,7 +320,7 @@ int main(int argc, char** argv) {
         // Expected for nt=10, nd=100000:  3600000 (0+1+..+8 = 36)
         {
             double* aplusData = aplusCollect.getCollectedDataPtr();
-            int     numSize   = aplusCollect.getNumSize();
+            std::size_t numSize = aplusCollect.getNumSize();
             double  checksum  = std::accumulate(aplusData, aplusData + numSize, 0.0);
             printf("aplusCollect accumulator (chunk 0) checksum: %.0lf\n", checksum);
         }
@@ -0,0 +1,182 @@
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <map>
+#include <array>
+#include <algorithm>
+#include <set>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepWorker.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Task
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds sleep # milliseconds at each step
+ */
+void
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm, int milliseconds) {
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds) );
+        int output[3] = {task_id, step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+/**
+ * Count the forcing slabs loaded by two single-worker nodes for a fixed dispatch
+ * sequence. Each round, the two nodes are free and receive one task of range A and one
+ * of range B, in alternating queue order
+ * @param locality whether the worker is chosen with TaskStepManager::chooseLocalWorker
+ * @param numRounds number of rounds
+ * @return number of slab loads
+ */
+int countSlabLoads(bool locality, int numRounds) {
+    const std::array<int, 2> rangeA = {0, 5};
+    const std::array<int, 2> rangeB = {10, 15};
+    // rank 0 is the manager, ranks 1 and 2 are on nodes 0 and 1
+    const std::vector<int> workerNodes = {0, 0, 1};
+    std::map<int, std::array<int, 2> > nodeTimeRanges;
+    int numLoads = 0;
+    for (int round = 0; round < numRounds; ++round) {
+        std::multiset<int> freeWorkers = {1, 2};
+        std::vector<std::array<int, 2> > queue = {rangeA, rangeB};
+        if (round % 2 == 1) std::swap(queue[0], queue[1]);
+        for (const auto& range : queue) {
+            int worker = locality ?
+                TaskStepManager::chooseLocalWorker(range, freeWorkers, workerNodes, nodeTimeRanges) :
+                *freeWorkers.begin();
+            freeWorkers.erase(worker);
+            int node = workerNodes[worker];
+            int overlap = 0;
+            auto it = nodeTimeRanges.find(node);
+            if (it != nodeTimeRanges.end()) {
+                overlap = std::max(0, std::min(range[1], it->second[1]) - std::max(range[0], it->second[0]));
+            }
+            numLoads += range[1] - range[0] - overlap;
+            nodeTimeRanges[node] = range;
+        }
+    }
+    return numLoads;
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Compare the number of forcing time slabs loaded per node with and without forcing locality.");
+    cmdLine.set("-na", 5, "Number of age groups");
+    cmdLine.set("-nt", 20, "Total number of steps");
+    cmdLine.set("-nm", 5, "Sleep milliseconds");
+    cmdLine.set("-rpn", 2, "Number of worker ranks per (virtual) node");
+    cmdLine.set("-timing", false, "Also compare the slab loads of a timed cohort run (not deterministic)");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int ranksPerNode = cmdLine.get<int>("-rpn");
+    bool timing = cmdLine.get<bool>("-timing");
+
+    // deterministic check of the dispatch rule
+    if (workerId == 0) {
+        const std::vector<int> workerNodes = {0, 0, 0, 1, 1};
+        const std::map<int, std::array<int, 2> > nodeTimeRanges = {{0, {0, 5}}, {1, {10, 15}}};
+        const std::multiset<int> freeWorkers = {1, 2, 3, 4};
+        // most overlap, lowest free rank without overlap
+        assert(TaskStepManager::chooseLocalWorker({11, 16}, freeWorkers, workerNodes, nodeTimeRanges) == 3);
+        assert(TaskStepManager::chooseLocalWorker({2, 6}, freeWorkers, workerNodes, nodeTimeRanges) == 1);
+        assert(TaskStepManager::chooseLocalWorker({20, 25}, freeWorkers, workerNodes, nodeTimeRanges) == 1);
+        assert(TaskStepManager::chooseLocalWorker({11, 16}, {1, 2}, workerNodes, nodeTimeRanges) == 1);
+
+        int loadsOff = countSlabLoads(false, 4);
+        int loadsOn = countSlabLoads(true, 4);
+        std::cout << "Fixed sequence slab loads, locality off: " << loadsOff << " on: " << loadsOn << '\n';
+        assert(loadsOff == 40);
+        assert(loadsOn == 10);
+    }
+
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps);
+
+    // the real nodes, then virtual nodes of ranksPerNode workers to emulate a cluster
+    std::vector<int> nodeIds = TaskStepManager::getNodeIds(MPI_COMM_WORLD);
+    assert(nodeIds[workerId] <= workerId);
+    std::vector<int> virtualNodes(size, 0);
+    for (int rank = 1; rank < size; ++rank) virtualNodes[rank] = (rank - 1) / ranksPerNode;
+    int numNodes = virtualNodes[size - 1] + 1;
+
+    auto taskFunc = std::bind(taskFunction,
+        std::placeholders::_1, // task_id
+        std::placeholders::_2, // stepBeg
+        std::placeholders::_3, // stepEnd
+        std::placeholders::_4, // comm
+        milliseconds);
+    TaskStepWorker worker(MPI_COMM_WORLD, taskFunc, taskDeps.getStepBegMap(), taskDeps.getStepEndMap());
+
+    // a node loads the time slabs by which its range grows and evicts those it leaves
+    int numLoads[2];
+    for (int locality = 0; timing && locality < 2; ++locality) {
+
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        if (workerId == 0) {
+            TaskStepManager manager(MPI_COMM_WORLD, taskDeps.getNumberOfCohorts(),
+                taskDeps.getStepBegMap(), taskDeps.getStepEndMap(), taskDeps.getDependencyMap());
+            manager.setForcingLocality(taskDeps.getTimeRangeMap(), virtualNodes, locality == 1);
+            std::map<int, std::array<int, 2> > held;
+            numLoads[locality] = 0;
+            manager.setTimeRangeListener([&](int node, int tBeg, int tEnd) {
+                auto it = held.find(node);
+                int overlap = 0;
+                if (it != held.end()) {
+                    overlap = std::max(0, std::min(tEnd, it->second[1]) - std::max(tBeg, it->second[0]));
+                }
+                numLoads[locality] += tEnd - tBeg - overlap;
+                held[node] = {tBeg, tEnd};
+            });
+            const auto results = manager.run();
+            assert(results.size() == (std::size_t) taskDeps.getNumberOfCohortSteps());
+            assert(manager.getNodeTimeRanges().size() <= (std::size_t) numNodes);
+            std::cout << "Locality: " << locality << " Nodes: " << numNodes
+                      << " Slab loads: " << numLoads[locality]
+                      << " (ideal: " << numTimeSteps << ")\n";
+        } else {
+            worker.run();
+        }
+    }
+
+    // the loads of the timed runs depend on the completion order, they are only reported
+    if (workerId == 0) {
+        std::cout << "Success\n";
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <mpi.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <array>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepWorker.h"
+#include "TaskStepPublisher.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Zero-work task, notifies the manager of each step right away
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ */
+void
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm, TaskStepPublisher* publisher) {
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        if (publisher) {
+            publisher->publishStep(task_id, step, task_id);
+            continue;
+        }
+        int output[3] = {task_id, step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Measure the TaskStepManager throughput in completed steps per second with zero-work tasks.");
+    cmdLine.set("-nt", 1000, "Number of independent tasks");
+    cmdLine.set("-ns", 100, "Number of steps per task");
+    cmdLine.set("-depth", 0, "Number of persistent receives per worker (0: MPI_Iprobe + MPI_Recv)");
+    cmdLine.set("-publish", false, "Notify the steps through the RMA completion board");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numTasks = cmdLine.get<int>("-nt");
+    int numSteps = cmdLine.get<int>("-ns");
+    int depth = cmdLine.get<int>("-depth");
+    bool publish = cmdLine.get<bool>("-publish");
+
+    std::map<int, int> stepBegMap, stepEndMap;
+    std::map<int, std::set<dep_type> > dependencyMap;
+    for (int task_id = 0; task_id < numTasks; ++task_id) {
+        stepBegMap[task_id] = 0;
+        stepEndMap[task_id] = numSteps;
+        dependencyMap[task_id] = {};
+    }
+
+    TaskStepPublisher publisher(MPI_COMM_WORLD, stepBegMap, stepEndMap);
+    auto taskFunc = [&](int task_id, int stepBeg, int stepEnd, MPI_Comm comm) {
+        taskFunction(task_id, stepBeg, stepEnd, comm, publish ? &publisher : nullptr);
+    };
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (workerId == 0) {
+
+        TaskStepManager manager(MPI_COMM_WORLD, numTasks, stepBegMap, stepEndMap, dependencyMap);
+        manager.setCompletionDepth(depth);
+        if (publish) manager.setPublisher(&publisher);
+
+        double tic = MPI_Wtime();
+        const auto results = manager.run();
+        double toc = MPI_Wtime();
+
+        assert(results.size() == (std::size_t) numTasks * numSteps);
+        std::cout << "Receive depth: " << depth << " Publish: " << publish << " Workers: " << size - 1
+                  << " Completions per second: " << double(results.size()) / (toc - tic) << '\n';
+        std::cout << "Success\n";
+
+    } else {
+
+        TaskStepWorker worker(MPI_COMM_WORLD, taskFunc, stepBegMap, stepEndMap);
+        worker.run();
+
+    }
+
+    publisher.free();
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <mpi.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <array>
+#include <vector>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepWorker.h"
+#include "DistDataCollector.h"
+#include "SeapodymCohortFake.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Task, counts its steps in the state of a cohort. The state is saved into the
+ * state collector when the task is cancelled and restored when it is resumed
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds duration of a step
+ * @param numData size of the cohort state
+ * @param firstStep first step of the task when it is not resumed
+ * @param stateCollect collector of the cohort states, one chunk per task
+ */
+void
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm,
+    int milliseconds, int numData, int firstStep, DistDataCollector* stateCollect) {
+
+    SeapodymCohortFake cohort(milliseconds, numData, task_id);
+    if (stepBeg != firstStep) {
+        // migrated, restore the state at the end of step stepBeg - 1
+        std::vector<double> state(numData);
+        stateCollect->get(task_id, state.data());
+        cohort.setStateFromArray(state);
+    } else {
+        cohort.setStateFromArray(std::vector<double>(numData, 0.0));
+    }
+
+    dvar_vector no_param;
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        if (TaskStepWorker::isCancelled(comm, task_id)) {
+            stateCollect->put(task_id, cohort.getArrayFromState().data());
+            return;
+        }
+        cohort.stepForward(no_param);
+        std::vector<double> state = cohort.getArrayFromState();
+        for (auto& x : state) x += 1;
+        cohort.setStateFromArray(state);
+
+        int output[3] = {task_id, step, int(state[0])};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Compare the run time with and without task migration when one worker is slow.");
+    cmdLine.set("-nt", 3, "Number of independent tasks");
+    cmdLine.set("-ns", 10, "Number of steps per task");
+    cmdLine.set("-nm", 5, "Step milliseconds");
+    cmdLine.set("-nd", 100, "Size of the cohort state");
+    cmdLine.set("-slow", 10, "Slowdown of worker 1");
+    cmdLine.set("-factor", 2.0, "Migration factor");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numTasks = cmdLine.get<int>("-nt");
+    int numSteps = cmdLine.get<int>("-ns");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int numData = cmdLine.get<int>("-nd");
+    int slowdown = cmdLine.get<int>("-slow");
+    double factor = cmdLine.get<double>("-factor");
+
+    std::map<int, int> stepBegMap, stepEndMap;
+    std::map<int, std::set<dep_type> > dependencyMap;
+    for (int task_id = 0; task_id < numTasks; ++task_id) {
+        stepBegMap[task_id] = 0;
+        stepEndMap[task_id] = numSteps;
+        dependencyMap[task_id] = {};
+    }
+
+    DistDataCollector stateCollect(MPI_COMM_WORLD, numTasks, numData);
+
+    // worker 1 is slow, e.g. on an oversubscribed node
+    int ms = (workerId == 1) ? slowdown * milliseconds : milliseconds;
+    auto taskFunc = [&](int task_id, int stepBeg, int stepEnd, MPI_Comm comm) {
+        taskFunction(task_id, stepBeg, stepEnd, comm, ms, numData, stepBegMap.at(task_id), &stateCollect);
+    };
+    TaskStepWorker worker(MPI_COMM_WORLD, taskFunc, stepBegMap, stepEndMap);
+
+    double times[2];
+    for (int migrate = 0; migrate < 2; ++migrate) {
+
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        if (workerId == 0) {
+            TaskStepManager manager(MPI_COMM_WORLD, numTasks, stepBegMap, stepEndMap, dependencyMap);
+            manager.setMigration(migrate ? factor : 0);
+            double tic = MPI_Wtime();
+            const auto results = manager.run();
+            times[migrate] = MPI_Wtime() - tic;
+            assert(results.size() == (std::size_t) numTasks * numSteps);
+            // the state survived the migrations
+            for (const auto& r : results) assert(r[2] == r[1] + 1);
+            std::cout << "Migration: " << migrate << " Migrated: " << manager.getNumMigrated()
+                      << " Time: " << times[migrate] << " s\n";
+            if (migrate) assert(manager.getNumMigrated() > 0);
+        } else {
+            worker.run();
+        }
+    }
+
+    if (workerId == 0) {
+        assert(times[1] < times[0]);
+        std::cout << "Success\n";
+    }
+
+    stateCollect.free();
+
+    MPI_Finalize();
+    return 0;
+}
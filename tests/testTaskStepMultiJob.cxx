@@ -0,0 +1,179 @@
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <cstdio>
+#include <stdexcept>
+#include <CmdLineArgParser.h>
+#include "TaskStepMultiManager.h"
+#include "TaskStepMultiWorker.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Return the chunk Id
+ * @param task_id Id of the task (same as cohort Id)
+ * @param step step in the task
+ * @return index
+ */
+int inline getChunkId(int task_id, int step, int numAgeGroups) {
+    int row = task_id + step - numAgeGroups + 1;
+    int col = task_id % numAgeGroups;
+    return row * numAgeGroups + col;
+}
+
+/**
+ * Task, job j produces (j + 1) * task_id in its own collector
+ * @param job job Id
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds sleep # milliseconds at each step
+ */
+void inline
+taskFunction(int job, int task_id, int stepBeg, int stepEnd, MPI_Comm comm,
+    int milliseconds, int numAgeGroups, int numData,
+    std::vector< std::unique_ptr<DistDataCollector> >* dataCollectors) {
+
+    std::vector<double> localData(numData);
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds) );
+        std::fill(localData.begin(), localData.end(), double(job + 1) * double(task_id));
+        (*dataCollectors)[job]->put(getChunkId(task_id, step, numAgeGroups), localData.data());
+        // Notify the manager at the end of each step
+        int output[3] = {TaskStepMultiManager::getTaskId(job, task_id), step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    // MPI initialization
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int numWorkers = size - 1;
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.set("-na", 5, "Number of age groups");
+    cmdLine.set("-nt", 5, "Total number of steps");
+    cmdLine.set("-nj", 3, "Number of jobs");
+    cmdLine.set("-nm", 10, "Sleep milliseconds");
+    cmdLine.set("-nd", 1000, "Number of data values to send from worker to manager at each step");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int numJobs = cmdLine.get<int>("-nj");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int numData = cmdLine.get<int>("-nd");
+
+    // all the jobs have the same graph here, but they need not
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps);
+    int numCohortSteps = taskDeps.getNumberOfCohortSteps();
+
+    // one collector per job
+    std::vector< std::unique_ptr<DistDataCollector> > dataCollectors;
+    for (int job = 0; job < numJobs; ++job) {
+        dataCollectors.push_back(std::make_unique<DistDataCollector>(MPI_COMM_WORLD, numAgeGroups * numTimeSteps, numData));
+    }
+
+    auto taskFunc = std::bind(taskFunction,
+        std::placeholders::_1, // job
+        std::placeholders::_2, // task_id
+        std::placeholders::_3, // stepBeg
+        std::placeholders::_4, // stepEnd
+        std::placeholders::_5, // comm
+        milliseconds,
+        numAgeGroups,
+        numData,
+        &dataCollectors);
+
+    // sync the manager and workers
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (workerId == 0) {
+
+        {
+            // the job Id travels in the task Id, which limits the number of jobs
+            TaskStepMultiManager tooMany(MPI_COMM_WORLD);
+            for (int job = 0; job < TaskStepMultiManager::MAX_JOBS; ++job) tooMany.addJob({}, {}, {});
+            bool rejected = false;
+            try {
+                tooMany.addJob({}, {}, {});
+            } catch (const std::invalid_argument&) {
+                rejected = true;
+            }
+            assert(rejected);
+        }
+
+        TaskStepMultiManager manager(MPI_COMM_WORLD);
+        for (int job = 0; job < numJobs; ++job) {
+            manager.addJob(taskDeps.getStepBegMap(), taskDeps.getStepEndMap(), taskDeps.getDependencyMap());
+        }
+
+        double tic = MPI_Wtime();
+        const auto results = manager.run();
+        double toc = MPI_Wtime();
+
+        double speedup = 0.001*double(numJobs * numCohortSteps * milliseconds)/(toc - tic);
+        std::cout << "Execution time: " << toc - tic <<
+            " Speedup: " << speedup <<
+            " Ideal: " << numWorkers <<
+            " Parallel eff: " << speedup/double(numWorkers) << std::endl;
+
+        assert(results.size() == (std::size_t) numJobs);
+        for (const auto& [job, jobResults] : results) {
+            assert(jobResults.size() == (std::size_t) numCohortSteps);
+            for (auto [taskId, step, res] : jobResults) {
+                assert(taskId == res);
+            }
+        }
+
+        // the data of each job are in their own collector
+        for (int job = 0; job < numJobs; ++job) {
+            double* data = dataCollectors[job]->getCollectedDataPtr();
+            double checksum = 0;
+            for (std::size_t i = 0; i < dataCollectors[job]->getNumChunks() * numData; ++i) {
+                checksum += data[i];
+            }
+            printf("job %d checksum: %.0lf\n", job, checksum);
+        }
+        std::cout << "Success\n";
+
+    } else {
+
+        TaskStepMultiWorker worker(MPI_COMM_WORLD, taskFunc);
+        for (int job = 0; job < numJobs; ++job) {
+            worker.addJob(taskDeps.getStepBegMap(), taskDeps.getStepEndMap());
+        }
+        worker.run();
+
+    }
+
+    for (auto& dc : dataCollectors) dc->free();
+
+    MPI_Finalize();
+    return 0;
+}
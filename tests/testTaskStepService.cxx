@@ -0,0 +1,154 @@
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <CmdLineArgParser.h>
+#include "TaskStepService.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Return the chunk Id
+ * @param task_id Id of the task (same as cohort Id)
+ * @param step step in the task
+ * @return index
+ */
+int inline getChunkId(int task_id, int step, int numAgeGroups) {
+    int row = task_id + step - numAgeGroups + 1;
+    int col = task_id % numAgeGroups;
+    return row * numAgeGroups + col;
+}
+
+/**
+ * Task, the cohort data are the task Id times the first parameter
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds sleep # milliseconds at each step
+ * @param params current parameter values
+ */
+void inline
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm,
+    int milliseconds, int numAgeGroups, int numData,
+    DistDataCollector* dataCollector,
+    const std::vector<double>* params) {
+
+    std::vector<double> localData(numData);
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds) );
+        std::fill(localData.begin(), localData.end(), (*params)[0] * double(task_id));
+        dataCollector->put(getChunkId(task_id, step, numAgeGroups), localData.data());
+        int output[3] = {task_id, step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    // MPI initialization
+    MPI_Init(&argc, &argv);
+    int workerId;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.set("-na", 5, "Number of age groups");
+    cmdLine.set("-nt", 5, "Total number of steps");
+    cmdLine.set("-nm", 1, "Sleep milliseconds");
+    cmdLine.set("-nd", 1000, "Number of data values to send from worker to manager at each step");
+    cmdLine.set("-ne", 5, "Number of model evaluations");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int numData = cmdLine.get<int>("-nd");
+    int numEvaluations = cmdLine.get<int>("-ne");
+
+    // the expensive set up is done once
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps);
+    int numCohortSteps = taskDeps.getNumberOfCohortSteps();
+    DistDataCollector dataCollect(MPI_COMM_WORLD, numAgeGroups * numTimeSteps, numData);
+
+    std::vector<double> params;
+    auto taskFunc = std::bind(taskFunction,
+        std::placeholders::_1, // task_id
+        std::placeholders::_2, // stepBeg
+        std::placeholders::_3, // stepEnd
+        std::placeholders::_4, // comm
+        milliseconds,
+        numAgeGroups,
+        numData,
+        &dataCollect,
+        &params);
+
+    TaskStepService service(MPI_COMM_WORLD, taskDeps.getNumberOfCohorts(),
+        taskDeps.getStepBegMap(), taskDeps.getStepEndMap(), taskDeps.getDependencyMap(), taskFunc);
+    service.setParameterFunction([&params](const std::vector<double>& p) { params = p; });
+
+    // the objective is the sum of the collected data, only known on the manager
+    service.setObjectiveFunction([&](std::vector<double>& gradient) {
+        if (workerId != 0) return 0.0;
+        const double* data = dataCollect.getCollectedDataPtr();
+        double sum = 0;
+        for (std::size_t i = 0; i < dataCollect.getNumChunks() * dataCollect.getNumSize(); ++i) sum += data[i];
+        // linear in the first parameter
+        if (!gradient.empty()) gradient[0] = sum / params[0];
+        return sum;
+    });
+
+    // sync the manager and workers
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (workerId == 0) {
+
+        double objective1 = 0;
+        double tic = MPI_Wtime();
+        for (int iter = 0; iter < numEvaluations; ++iter) {
+            std::vector<double> p = {double(iter + 1)};
+            std::vector<double> gradient(1);
+            double objective = service.evaluate(p, gradient);
+            assert(service.getLastResults().size() == (std::size_t) numCohortSteps);
+            if (iter == 0) objective1 = objective;
+            printf("evaluation %d objective: %.0lf gradient: %.0lf\n", iter, objective, gradient[0]);
+            assert(std::fabs(objective - p[0] * objective1) < 1.e-6 * std::fabs(objective));
+            assert(std::fabs(gradient[0] - objective1) < 1.e-6 * std::fabs(objective1));
+        }
+        double toc = MPI_Wtime();
+        service.stop();
+
+        std::cout << "Time per evaluation: " << (toc - tic) / numEvaluations << " secs\n";
+        assert(service.getNumEvaluations() == numEvaluations);
+        std::cout << "Success\n";
+
+    } else {
+
+        service.serve();
+
+    }
+
+    dataCollect.free();
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <random>
+#include <map>
+#include <array>
+#include <chrono>
+#include "CmdLineArgParser.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "SeapodymCohortParallelismAnalyzer.h"
+#include "TaskStepSimulator.h"
+#include "TaskStepProfile.h"
+#include <algorithm>
+#undef NDEBUG
+#include <cassert>
+
+int main(int argc, char** argv) {
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Simulate the TaskStepManager scheduling of a cohort DAG on virtual workers.");
+    cmdLine.set("-na", 5, "Number of age groups");
+    cmdLine.set("-nt", 10, "Total number of time steps");
+    cmdLine.set("-age_mature", 0, "Index of the first mature age class");
+    cmdLine.set("-aplus", false, "Add the A+ cohorts");
+    cmdLine.set("-nw", 4, "Number of virtual workers");
+    cmdLine.set("-nm", 100, "Mean step cost in milliseconds");
+    cmdLine.set("-sd", 0.1, "Step cost standard deviation in milliseconds (> 0)");
+    cmdLine.set("-ni", 10, "Cohort initialisation cost in milliseconds");
+    cmdLine.set("-seed", 123456789, "Random seed");
+    cmdLine.set("-trace", std::string(""), "Profile of measured step costs, see TaskStepProfile::save (replaces -nm/-sd)");
+    cmdLine.set("-latency", 2.0, "Message latency in microseconds");
+    cmdLine.set("-overhead", 1.0, "Manager time per message in microseconds");
+    cmdLine.set("-rma_latency", 5.0, "RMA put/get latency in microseconds");
+    cmdLine.set("-bandwidth", 5.0, "RMA bandwidth in GB/s");
+    cmdLine.set("-nd", 10000, "Number of doubles per chunk");
+    cmdLine.set("-priority", false, "Dispatch the longest remaining critical path first (costs from -trace)");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int ageMature = cmdLine.get<int>("-age_mature");
+    bool aPlus = cmdLine.get<bool>("-aplus");
+    int numWorkers = cmdLine.get<int>("-nw");
+    int milliseconds = cmdLine.get<int>("-nm");
+    double sd = cmdLine.get<double>("-sd");
+    int init_milliseconds = cmdLine.get<int>("-ni");
+    std::string traceFile = cmdLine.get<std::string>("-trace");
+
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps, ageMature, aPlus);
+    TaskStepSimulator sim(numWorkers, taskDeps.getStepBegMap(), taskDeps.getStepEndMap(),
+                          taskDeps.getDependencyMap());
+
+    // same gamma distribution as the testTaskStepFarming* drivers
+    std::mt19937 rng;
+    rng.seed(cmdLine.get<int>("-seed"));
+    double k = (double(milliseconds) * milliseconds) / (sd * sd);
+    double theta = (sd * sd) / double(milliseconds);
+    std::gamma_distribution<double> dist(k, theta);
+    // measured costs, in the format written by TaskStepManager::getMeasuredProfile
+    TaskStepProfile profile;
+    if (!traceFile.empty()) {
+        if (!profile.load(traceFile)) return 1;
+        std::cout << "Read " << profile.size() << " step costs from " << traceFile << '\n';
+    }
+
+    sim.setCostFunction([&](int task_id, int step, int) {
+        // the steps missing from the profile get the mean cost of their step index
+        if (profile.size() > 0) return profile.getCost(task_id, step);
+        return 0.001 * dist(rng);
+    });
+    if (cmdLine.get<bool>("-priority")) {
+        // same policy as TaskStepManager::setProfile
+        std::map<int, double> priorities = profile.getPriorities(
+            taskDeps.getStepBegMap(), taskDeps.getStepEndMap(), taskDeps.getDependencyMap());
+        sim.setPolicy([priorities](const std::set<int>& readyTasks) {
+            return *std::max_element(readyTasks.begin(), readyTasks.end(), [&](int a, int b) {
+                return priorities.at(a) < priorities.at(b);
+            });
+        });
+    }
+    sim.setInitCost(0.001 * init_milliseconds);
+    sim.setMessageParameters(1.e-6 * cmdLine.get<double>("-latency"),
+                             1.e-6 * cmdLine.get<double>("-overhead"));
+    sim.setRmaParameters(1.e-6 * cmdLine.get<double>("-rma_latency"),
+                         1.e9 * cmdLine.get<double>("-bandwidth"),
+                         cmdLine.get<int>("-nd") * sizeof(double));
+
+    auto tic = std::chrono::steady_clock::now();
+    TaskStepSimulatorResult res = sim.run();
+    auto toc = std::chrono::steady_clock::now();
+
+    int numCohortSteps = taskDeps.getNumberOfCohortSteps();
+    double speedup = numCohortSteps * 0.001 * milliseconds / res.makespan;
+    std::cout << "Predicted makespan: " << res.makespan
+              << " Speedup: " << speedup
+              << " Ideal: " << numWorkers
+              << " Parallel eff: " << speedup / double(numWorkers) << '\n';
+    std::cout << "Mean worker idle time: " << res.meanWorkerIdleTime << '\n';
+    std::cout << "Manager queue depth max: " << res.maxManagerQueueDepth
+              << " mean: " << res.meanManagerQueueDepth << '\n';
+    std::cout << "Max ready tasks waiting: " << res.maxReadyTasks << '\n';
+    std::cout << "Manager messages: " << res.numMessages << '\n';
+    std::cout << "Simulation time: " << std::chrono::duration<double>(toc - tic).count() << " secs\n";
+
+    assert(res.numSteps == (std::size_t)numCohortSteps);
+    if (traceFile.empty()) {
+        // cannot beat the critical path or the perfectly balanced load (allow for the cost spread)
+        SeapodymCohortParallelismAnalyzer parAnalyzer(taskDeps);
+        double lowerBound = 0.001 * milliseconds * double(numCohortSteps) / parAnalyzer.getSpeedupBound(numWorkers);
+        assert(res.makespan >= 0.99 * lowerBound);
+    }
+
+    std::cout << "Success\n";
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <mpi.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <array>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepWorker.h"
+#include "DistDataCollector.h"
+#include "SeapodymCohortFake.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Task, stops early if the manager cancels it
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds sleep # milliseconds at each step
+ */
+void
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm, int milliseconds) {
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        if (TaskStepWorker::isCancelled(comm, task_id)) return;
+        std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds) );
+        int output[3] = {task_id, step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+/**
+ * Stateful task, counts its steps in the state of a cohort. Since the original copy
+ * keeps running while its duplicate runs, the state of every step is saved into its
+ * own chunk, which a duplicate resumed at step stepBeg reads back from step stepBeg - 1
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds duration of a step
+ * @param numData size of the cohort state
+ * @param firstStep first step of the task when it is not resumed
+ * @param numSteps number of steps per task
+ * @param stateCollect collector of the cohort states, one chunk per task and step
+ */
+void
+statefulTaskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm, int milliseconds,
+    int numData, int firstStep, int numSteps, DistDataCollector* stateCollect) {
+
+    SeapodymCohortFake cohort(milliseconds, numData, task_id);
+    if (stepBeg != firstStep) {
+        // duplicate, restore the state at the end of step stepBeg - 1
+        std::vector<double> state(numData);
+        stateCollect->get(task_id * numSteps + stepBeg - 1 - firstStep, state.data());
+        cohort.setStateFromArray(state);
+    } else {
+        cohort.setStateFromArray(std::vector<double>(numData, 0.0));
+    }
+
+    dvar_vector no_param;
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        if (TaskStepWorker::isCancelled(comm, task_id)) return;
+        cohort.stepForward(no_param);
+        std::vector<double> state = cohort.getArrayFromState();
+        for (auto& x : state) x += 1;
+        cohort.setStateFromArray(state);
+
+        // both copies write the same values, the state must be saved before the step is signalled
+        stateCollect->put(task_id * numSteps + step - firstStep, state.data());
+        int output[3] = {task_id, step, int(state[0])};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.setPurpose("Compare the run time with and without speculative duplicates when one worker is slow.");
+    cmdLine.set("-nt", 6, "Number of independent tasks");
+    cmdLine.set("-ns", 10, "Number of steps per task");
+    cmdLine.set("-nm", 5, "Sleep milliseconds per step");
+    cmdLine.set("-slow", 10, "Slowdown of worker 1");
+    cmdLine.set("-spec", 3.0, "Speculation factor");
+    cmdLine.set("-nd", 100, "Size of the cohort state (with -state)");
+    cmdLine.set("-state", false, "Run stateful tasks, whose duplicates restore the state of the previous step");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numTasks = cmdLine.get<int>("-nt");
+    int numSteps = cmdLine.get<int>("-ns");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int slowdown = cmdLine.get<int>("-slow");
+    double speculation = cmdLine.get<double>("-spec");
+    int numData = cmdLine.get<int>("-nd");
+    bool stateful = cmdLine.get<bool>("-state");
+
+    std::map<int, int> stepBegMap, stepEndMap;
+    std::map<int, std::set<dep_type> > dependencyMap;
+    for (int task_id = 0; task_id < numTasks; ++task_id) {
+        stepBegMap[task_id] = 0;
+        stepEndMap[task_id] = numSteps;
+        dependencyMap[task_id] = {};
+    }
+
+    // worker 1 is slow, e.g. on an oversubscribed node
+    int ms = (workerId == 1) ? slowdown * milliseconds : milliseconds;
+    DistDataCollector stateCollect(MPI_COMM_WORLD, stateful ? numTasks * numSteps : 1, numData);
+    auto taskFunc = [&](int task_id, int stepBeg, int stepEnd, MPI_Comm comm) {
+        if (stateful) {
+            statefulTaskFunction(task_id, stepBeg, stepEnd, comm, ms, numData,
+                                 stepBegMap.at(task_id), numSteps, &stateCollect);
+        } else {
+            taskFunction(task_id, stepBeg, stepEnd, comm, ms);
+        }
+    };
+    TaskStepWorker worker(MPI_COMM_WORLD, taskFunc, stepBegMap, stepEndMap);
+
+    double times[2];
+    for (int spec = 0; spec < 2; ++spec) {
+
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        if (workerId == 0) {
+            TaskStepManager manager(MPI_COMM_WORLD, numTasks, stepBegMap, stepEndMap, dependencyMap);
+            manager.setSpeculation(spec ? speculation : 0);
+            double tic = MPI_Wtime();
+            const auto results = manager.run();
+            times[spec] = MPI_Wtime() - tic;
+            assert(results.size() == (std::size_t) numTasks * numSteps);
+            for (const auto& r : results) {
+                // with -state, the state survived the duplication
+                assert(stateful ? r[2] == r[1] + 1 : r[2] == r[0]);
+            }
+            std::cout << "Speculation: " << spec << " Duplicates: " << manager.getNumSpeculated()
+                      << " Time: " << times[spec] << " s\n";
+            if (spec) assert(manager.getNumSpeculated() > 0);
+        } else {
+            worker.run();
+        }
+    }
+
+    if (workerId == 0) {
+        assert(times[1] < times[0]);
+        std::cout << "Success\n";
+    }
+
+    stateCollect.free();
+
+    MPI_Finalize();
+    return 0;
+}
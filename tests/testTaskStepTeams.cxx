@@ -0,0 +1,197 @@
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepTeamWorker.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "DistDataCollector.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Return the chunk Id
+ * @param task_id Id of the task (same as cohort Id)
+ * @param step step in the task
+ * @return index
+ */
+int inline getChunkId(int task_id, int step, int numAgeGroups) {
+    int row = task_id + step - numAgeGroups + 1;
+    int col = task_id % numAgeGroups;
+    return row * numAgeGroups + col;
+}
+
+/**
+ * Task executed by a team, each member computing a slice of the data
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param teamComm team communicator
+ * @param milliseconds sleep # milliseconds at each step if the task was run by a single rank
+ */
+void inline
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm, MPI_Comm teamComm,
+    int milliseconds, int numAgeGroups, int numData,
+    DistDataCollector* dataCollector,
+    std::map<int, std::set<std::array<int, 2>>>* dependencyMap) {
+
+    int teamRank, teamSize;
+    MPI_Comm_rank(teamComm, &teamRank);
+    MPI_Comm_size(teamComm, &teamSize);
+
+    // domain decomposition of the data
+    std::vector<int> counts(teamSize), displs(teamSize);
+    for (int i = 0; i < teamSize; ++i) {
+        displs[i] = (i * numData) / teamSize;
+        counts[i] = ((i + 1) * numData) / teamSize - displs[i];
+    }
+
+    // the leader fetches the initial conditions and scatters them to the team
+    std::vector<double> data(numData, 0.0);
+    if (teamRank == 0) {
+        std::vector<double> buffer(numData);
+        for (const auto& [task_id2, step] : (*dependencyMap)[task_id]) {
+            dataCollector->get(getChunkId(task_id2, step, numAgeGroups), buffer.data());
+            std::transform(buffer.begin(), buffer.end(), data.begin(), data.begin(), std::plus<double>());
+        }
+    }
+    std::vector<double> localData(counts[teamRank]);
+    MPI_Scatterv(data.data(), counts.data(), displs.data(), MPI_DOUBLE,
+                 localData.data(), counts[teamRank], MPI_DOUBLE, 0, teamComm);
+
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+
+        // the work is shared by the team
+        std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds / teamSize) );
+        std::fill(localData.begin(), localData.end(), double(task_id));
+
+        MPI_Gatherv(localData.data(), counts[teamRank], MPI_DOUBLE,
+                    data.data(), counts.data(), displs.data(), MPI_DOUBLE, 0, teamComm);
+
+        if (teamRank == 0) {
+            dataCollector->put(getChunkId(task_id, step, numAgeGroups), data.data());
+            // Notify the manager at the end of each step
+            int output[3] = {task_id, step, task_id};
+            const int endTaskTag = 1;
+            MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+
+    // MPI initialization
+    MPI_Init(&argc, &argv);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int numWorkers = size - 1;
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.set("-na", 5, "Number of age groups");
+    cmdLine.set("-nt", 5, "Total number of steps");
+    cmdLine.set("-nm", 20, "Sleep milliseconds for one rank");
+    cmdLine.set("-nd", 1000, "Number of grid points");
+    cmdLine.set("-np", 500, "Maximum number of grid points per rank, sets the team size");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int numData = cmdLine.get<int>("-nd");
+    int teamSize = TaskStepTeamWorker::chooseTeamSize(numData, cmdLine.get<int>("-np"), numWorkers);
+
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps);
+    int numCohortSteps = taskDeps.getNumberOfCohortSteps();
+    std::map<int, std::set<std::array<int, 2>>> dependencyMap = taskDeps.getDependencyMap();
+
+    DistDataCollector dataCollect(MPI_COMM_WORLD, numAgeGroups * numTimeSteps, numData);
+
+    auto taskFunc = std::bind(taskFunction,
+        std::placeholders::_1, // task_id
+        std::placeholders::_2, // stepBeg
+        std::placeholders::_3, // stepEnd
+        std::placeholders::_4, // comm
+        std::placeholders::_5, // teamComm
+        milliseconds,
+        numAgeGroups,
+        numData,
+        &dataCollect,
+        &dependencyMap);
+
+    // collective, also on the manager rank
+    TaskStepTeamWorker worker(MPI_COMM_WORLD, teamSize, taskFunc,
+        taskDeps.getStepBegMap(), taskDeps.getStepEndMap());
+
+    // sync the manager and workers
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (workerId == 0) {
+
+        TaskStepManager manager(MPI_COMM_WORLD, taskDeps.getNumberOfCohorts(),
+            taskDeps.getStepBegMap(), taskDeps.getStepEndMap(), dependencyMap);
+        manager.setTeamSize(teamSize);
+
+        if (teamSize > 1) {
+            // the teams assume that the manager rank runs no worker
+            manager.setColocatedWorker(true);
+            bool rejected = false;
+            try {
+                manager.run();
+            } catch (const std::invalid_argument&) {
+                rejected = true;
+            }
+            assert(rejected);
+            manager.setColocatedWorker(false);
+        }
+
+        double tic = MPI_Wtime();
+        const auto results = manager.run();
+        double toc = MPI_Wtime();
+
+        int numTeams = (numWorkers + teamSize - 1) / teamSize;
+        std::cout << "Team size: " << teamSize << " Number of teams: " << numTeams << '\n';
+        std::cout << "Execution time: " << toc - tic << std::endl;
+
+        assert(results.size() == (std::size_t) numCohortSteps);
+        for (auto [taskId, step, res] : results) {
+            assert(taskId == res);
+        }
+
+        double* data = dataCollect.getCollectedDataPtr();
+        double checksum = 0;
+        for (std::size_t i = 0; i < dataCollect.getNumChunks() * numData; ++i) checksum += data[i];
+        printf("checksum: %.0lf\n", checksum);
+        std::cout << "Success\n";
+
+    } else {
+
+        worker.run();
+
+    }
+
+    worker.free();
+    dataCollect.free();
+
+    MPI_Finalize();
+    return 0;
+}
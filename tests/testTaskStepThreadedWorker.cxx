@@ -0,0 +1,168 @@
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <CmdLineArgParser.h>
+#include "TaskStepManager.h"
+#include "TaskStepThreadedWorker.h"
+#include "SeapodymCohortDependencyAnalyzer.h"
+#include "DistDataCollector.h"
+#include "Trace.h"
+#undef NDEBUG
+#include <cassert>
+
+/**
+ * Return the chunk Id
+ * @param task_id Id of the task (same as cohort Id)
+ * @param step step in the task
+ * @return index
+ */
+int inline getChunkId(int task_id, int step, int numAgeGroups) {
+    int row = task_id + step - numAgeGroups + 1;
+    int col = task_id % numAgeGroups;
+    return row * numAgeGroups + col;
+}
+
+/**
+ * Thread safe task, the dependency map and the collector are shared by the threads
+ * @param task_id index 0.. numTasks - 1
+ * @param stepBeg first step index (inclusive)
+ * @param stepEnd last step index (exclusive)
+ * @param comm MPI communicator
+ * @param milliseconds sleep # milliseconds at each step
+ */
+void inline
+taskFunction(int task_id, int stepBeg, int stepEnd, MPI_Comm comm,
+    int milliseconds, int numAgeGroups, int numData,
+    DistDataCollector* dataCollector,
+    const std::map<int, std::set<std::array<int, 2>>>* dependencyMap) {
+
+    std::vector<double> localData(numData, 0.0);
+    std::vector<double> data(numData);
+    for (const auto& [task_id2, step] : dependencyMap->at(task_id)) {
+        dataCollector->get(getChunkId(task_id2, step, numAgeGroups), data.data());
+        std::transform(data.begin(), data.end(), localData.begin(), localData.begin(), std::plus<double>());
+    }
+
+    for (auto step = stepBeg; step < stepEnd; ++step) {
+        {
+            SEAPODYM_TRACE_SCOPE(TRACE_STEP_COMPUTE, task_id, step);
+            std::this_thread::sleep_for( std::chrono::milliseconds(milliseconds) );
+            std::fill(localData.begin(), localData.end(), double(task_id));
+        }
+        dataCollector->put(getChunkId(task_id, step, numAgeGroups), localData.data());
+
+        // Notify the manager at the end of each step, from this thread
+        int output[3] = {task_id, step, task_id};
+        const int endTaskTag = 1;
+        MPI_Send(output, 3, MPI_INT, 0, endTaskTag, comm);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    // MPI initialization, the worker threads call MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    int workerId, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &workerId);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int numWorkers = size - 1;
+    SEAPODYM_TRACE_INIT(MPI_COMM_WORLD);
+
+    // Parse the command line arguments
+    CmdLineArgParser cmdLine;
+    cmdLine.set("-na", 5, "Number of age groups");
+    cmdLine.set("-nt", 5, "Total number of steps");
+    cmdLine.set("-nm", 10, "Sleep milliseconds");
+    cmdLine.set("-nd", 1000, "Number of data values to send from worker to manager at each step");
+    cmdLine.set("-nth", 2, "Number of threads (slots) per worker");
+    bool success = cmdLine.parse(argc, argv);
+    bool help = cmdLine.get<bool>("-help") || cmdLine.get<bool>("-h");
+    if (!success) {
+        std::cerr << "Error parsing command line arguments." << std::endl;
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+    if (help) {
+        cmdLine.help();
+        MPI_Finalize();
+        return 1;
+    }
+
+    int numAgeGroups = cmdLine.get<int>("-na");
+    int numTimeSteps = cmdLine.get<int>("-nt");
+    int milliseconds = cmdLine.get<int>("-nm");
+    int numData = cmdLine.get<int>("-nd");
+    int numSlots = cmdLine.get<int>("-nth");
+    if (provided < MPI_THREAD_MULTIPLE) {
+        if (workerId == 0) std::cout << "MPI_THREAD_MULTIPLE is not supported, using one thread per worker\n";
+        numSlots = 1;
+    }
+
+    SeapodymCohortDependencyAnalyzer taskDeps(numAgeGroups, numTimeSteps);
+    int numCohortSteps = taskDeps.getNumberOfCohortSteps();
+    std::map<int, std::set<std::array<int, 2>>> dependencyMap = taskDeps.getDependencyMap();
+
+    DistDataCollector dataCollect(MPI_COMM_WORLD, numAgeGroups * numTimeSteps, numData);
+
+    auto taskFunc = std::bind(taskFunction,
+        std::placeholders::_1, // task_id
+        std::placeholders::_2, // stepBeg
+        std::placeholders::_3, // stepEnd
+        std::placeholders::_4, // comm
+        milliseconds,
+        numAgeGroups,
+        numData,
+        &dataCollect,
+        &dependencyMap);
+
+    // sync the manager and workers
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (workerId == 0) {
+
+        TaskStepManager manager(MPI_COMM_WORLD, taskDeps.getNumberOfCohorts(),
+            taskDeps.getStepBegMap(), taskDeps.getStepEndMap(), dependencyMap);
+        manager.setWorkerSlots(numSlots);
+
+        double tic = MPI_Wtime();
+        const auto results = manager.run();
+        double toc = MPI_Wtime();
+
+        double speedup = 0.001*double(numCohortSteps * milliseconds)/(toc - tic);
+        std::cout << "Execution time: " << toc - tic <<
+            " Speedup: " << speedup <<
+            " Ideal: " << numWorkers * numSlots <<
+            " Parallel eff: " << speedup/double(numWorkers * numSlots) << std::endl;
+
+        assert(results.size() == (std::size_t) numCohortSteps);
+        for (auto [taskId, step, res] : results) {
+            assert(taskId == res);
+        }
+
+        double* data = dataCollect.getCollectedDataPtr();
+        double checksum = 0;
+        for (std::size_t i = 0; i < dataCollect.getNumChunks() * numData; ++i) checksum += data[i];
+        printf("checksum: %.0lf\n", checksum);
+        std::cout << "Success\n";
+
+    } else {
+
+        TaskStepThreadedWorker worker(MPI_COMM_WORLD, numSlots, taskFunc,
+            taskDeps.getStepBegMap(), taskDeps.getStepEndMap());
+        worker.run();
+
+    }
+
+    dataCollect.free();
+
+    SEAPODYM_TRACE_FLUSH("trace");
+
+    MPI_Finalize();
+    return 0;
+}